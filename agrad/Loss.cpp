@@ -0,0 +1,113 @@
+#include "Loss.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using ValuePtr = std::shared_ptr<Value>;
+
+namespace
+{
+    void check_sizes(const std::vector<ValuePtr> &predictions, const std::vector<double> &targets)
+    {
+        if (predictions.empty())
+        {
+            throw std::invalid_argument("Loss needs at least one prediction");
+        }
+        if (predictions.size() != targets.size())
+        {
+            throw std::invalid_argument("Prediction and target size mismatch");
+        }
+    }
+
+    // Single node holding the batch loss. d_inputs holds d(loss)/d(prediction) for every
+    // prediction, computed during the forward pass.
+    ValuePtr fused_node(const std::vector<ValuePtr> &predictions, double loss, std::vector<double> d_inputs, const std::string &op)
+    {
+        auto out = Value::create(loss, predictions);
+        out->setOp(op);
+
+        // The node owns its children, so raw pointers are enough and avoid a reference cycle
+        std::vector<Value *> inputs;
+        inputs.reserve(predictions.size());
+        for (const auto &p : predictions)
+        {
+            inputs.push_back(p.get());
+        }
+
+        Value *node = out.get();
+        const size_t captured_bytes = inputs.capacity() * sizeof(Value *) + d_inputs.capacity() * sizeof(double);
+        out->setBackward([node, inputs = std::move(inputs), d_inputs = std::move(d_inputs)]()
+                         {
+            const double upstream = node->getGrad();
+            for (size_t i = 0; i < inputs.size(); i++)
+            {
+                inputs[i]->setGrad(inputs[i]->getGrad() + d_inputs[i] * upstream);
+            } },
+                         captured_bytes);
+
+        return out;
+    }
+}
+
+namespace agrad::loss
+{
+    ValuePtr mse(const std::vector<ValuePtr> &predictions, const std::vector<double> &targets)
+    {
+        AGRAD_PROFILE_OP("mse");
+        check_sizes(predictions, targets);
+        const double n = static_cast<double>(predictions.size());
+
+        double loss = 0.0;
+        std::vector<double> d_inputs(predictions.size());
+        for (size_t i = 0; i < predictions.size(); i++)
+        {
+            double diff = predictions[i]->getData() - targets[i];
+            loss += diff * diff;
+            d_inputs[i] = 2.0 * diff / n;
+        }
+
+        return fused_node(predictions, loss / n, std::move(d_inputs), "mse");
+    }
+
+    ValuePtr hinge(const std::vector<ValuePtr> &predictions, const std::vector<double> &targets)
+    {
+        AGRAD_PROFILE_OP("hinge");
+        check_sizes(predictions, targets);
+        const double n = static_cast<double>(predictions.size());
+
+        double loss = 0.0;
+        std::vector<double> d_inputs(predictions.size());
+        for (size_t i = 0; i < predictions.size(); i++)
+        {
+            double margin = 1.0 - targets[i] * predictions[i]->getData();
+            if (margin > 0.0)
+            {
+                loss += margin;
+                d_inputs[i] = -targets[i] / n;
+            }
+        }
+
+        return fused_node(predictions, loss / n, std::move(d_inputs), "hinge");
+    }
+
+    ValuePtr binary_cross_entropy_with_logits(const std::vector<ValuePtr> &logits, const std::vector<double> &targets)
+    {
+        AGRAD_PROFILE_OP("bce");
+        check_sizes(logits, targets);
+        const double n = static_cast<double>(logits.size());
+
+        double loss = 0.0;
+        std::vector<double> d_inputs(logits.size());
+        for (size_t i = 0; i < logits.size(); i++)
+        {
+            double z = logits[i]->getData();
+            double e = std::exp(-std::abs(z)); // in (0, 1], never overflows
+            loss += std::max(z, 0.0) - z * targets[i] + std::log1p(e);
+
+            double sigmoid = z >= 0.0 ? 1.0 / (1.0 + e) : e / (1.0 + e);
+            d_inputs[i] = (sigmoid - targets[i]) / n;
+        }
+
+        return fused_node(logits, loss / n, std::move(d_inputs), "bce");
+    }
+}
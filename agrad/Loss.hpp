@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+#include "agrad/Value.hpp"
+
+// Batch losses fused into a single graph node. Each takes the model outputs and the targets
+// of a batch, returns their mean loss as one Value whose children are the predictions, and
+// propagates the gradient of every prediction in one backward call.
+namespace agrad::loss
+{
+    // mean((p - y)^2)
+    Value::ValuePtr mse(const std::vector<Value::ValuePtr> &predictions, const std::vector<double> &targets);
+
+    // mean(max(0, 1 - y * p)) for targets in {-1, 1}
+    Value::ValuePtr hinge(const std::vector<Value::ValuePtr> &predictions, const std::vector<double> &targets);
+
+    // mean(-y * log(sigmoid(z)) - (1 - y) * log(1 - sigmoid(z))) for logits z and targets in [0, 1],
+    // computed as max(z, 0) - z * y + log(1 + exp(-|z|)) so large logits don't overflow
+    Value::ValuePtr binary_cross_entropy_with_logits(const std::vector<Value::ValuePtr> &logits, const std::vector<double> &targets);
+}
@@ -0,0 +1,156 @@
+#include "Memory.hpp"
+#include "Value.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace agrad::memory
+{
+    namespace
+    {
+        struct Registry
+        {
+            std::mutex mutex;
+            std::unordered_map<const Value *, uint64_t> serials;
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+    }
+
+    uint64_t Stats::sizeof_value()
+    {
+        return sizeof(Value);
+    }
+
+    std::ostream &operator<<(std::ostream &os, const Stats &stats)
+    {
+        os << "nodes alive: " << stats.alive << " (peak " << stats.peak_alive << ", created " << stats.created << ")"
+           << ", children: " << stats.children_bytes / 1024.0 << " KiB"
+           << ", closures: " << stats.closure_bytes / 1024.0 << " KiB"
+           << ", total: " << stats.bytes() / 1024.0 << " KiB";
+        return os;
+    }
+
+    Stats stats()
+    {
+        Stats s;
+        s.alive = detail::alive.load(std::memory_order_relaxed);
+        s.created = detail::created.load(std::memory_order_relaxed);
+        s.peak_alive = detail::peak_alive.load(std::memory_order_relaxed);
+        s.children_bytes = detail::children_bytes.load(std::memory_order_relaxed);
+        s.closure_bytes = detail::closure_bytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset_peak()
+    {
+        detail::peak_alive.store(detail::alive.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    uint64_t checkpoint()
+    {
+        return detail::created.load(std::memory_order_relaxed);
+    }
+
+    // Walks the live graph, so no other thread may create or release nodes meanwhile
+    LeakReport leaks_since(uint64_t marker)
+    {
+        LeakReport report;
+        std::lock_guard<std::mutex> lock(registry().mutex);
+
+        std::unordered_set<const Value *> leaked;
+        for (const auto &[node, serial] : registry().serials)
+        {
+            if (serial >= marker)
+            {
+                leaked.insert(node);
+            }
+        }
+        report.leaked = leaked.size();
+
+        std::unordered_set<const Value *> referenced;
+        for (const Value *node : leaked)
+        {
+            for (const auto &child : node->children)
+            {
+                if (leaked.count(child.get()))
+                {
+                    referenced.insert(child.get());
+                }
+            }
+        }
+
+        std::unordered_set<const Value *> reached;
+        for (const Value *root : leaked)
+        {
+            if (referenced.count(root))
+            {
+                continue;
+            }
+
+            std::unordered_set<const Value *> seen = {root};
+            std::vector<const Value *> stack = {root};
+            while (!stack.empty())
+            {
+                const Value *v = stack.back();
+                stack.pop_back();
+                for (const auto &child : v->children)
+                {
+                    if (leaked.count(child.get()) && seen.insert(child.get()).second)
+                    {
+                        stack.push_back(child.get());
+                    }
+                }
+            }
+            report.roots.push_back({root, root->weak_from_this().use_count(), seen.size()});
+            reached.insert(seen.begin(), seen.end());
+        }
+
+        // Leaked nodes inside a pure cycle are not reachable from any root; report one entry
+        // per cycle member so they are not silently dropped
+        for (const Value *node : leaked)
+        {
+            if (!reached.count(node))
+            {
+                report.roots.push_back({node, node->weak_from_this().use_count(), 1});
+            }
+        }
+
+        std::sort(report.roots.begin(), report.roots.end(), [](const LeakRoot &a, const LeakRoot &b)
+                  { return a.reachable > b.reachable; });
+        return report;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const LeakReport &report)
+    {
+        os << report.leaked << " leaked node(s), " << report.roots.size() << " root(s)\n";
+        for (const auto &root : report.roots)
+        {
+            os << "  " << (root.node->_op.empty() ? "leaf" : root.node->_op) << " @ " << root.node
+               << " (data=" << root.node->data << ", label=" << root.node->label << ")"
+               << ": use_count " << root.use_count << ", reaches " << root.reachable << " node(s)\n";
+        }
+        return os;
+    }
+
+    namespace detail
+    {
+        void register_node(const Value *node, uint64_t serial)
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().serials[node] = serial;
+        }
+
+        void unregister_node(const Value *node)
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().serials.erase(node);
+        }
+    }
+}
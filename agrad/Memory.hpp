@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+class Value;
+
+// Live graph memory accounting. Every Value constructor and destructor updates a few relaxed
+// atomic counters, so stats() is cheap enough to poll once per training step. Building with
+// AGRAD_DEBUG_LEAKS additionally keeps a registry of live nodes for leaks_since().
+namespace agrad::memory
+{
+    struct Stats
+    {
+        uint64_t alive = 0;
+        uint64_t created = 0;
+        uint64_t peak_alive = 0;
+        uint64_t children_bytes = 0; // capacity of all children vectors
+        uint64_t closure_bytes = 0;  // state captured by backward closures
+
+        uint64_t bytes() const { return alive * sizeof_value() + children_bytes + closure_bytes; }
+        static uint64_t sizeof_value();
+    };
+
+    std::ostream &operator<<(std::ostream &os, const Stats &stats);
+
+    Stats stats();
+    // Restarts peak tracking from the current number of live nodes
+    void reset_peak();
+
+    constexpr bool leak_detection_enabled()
+    {
+#ifdef AGRAD_DEBUG_LEAKS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Nodes created after a checkpoint that are still alive, grouped by the roots that keep
+    // them reachable. A root is a leaked node that no other leaked node points to.
+    struct LeakRoot
+    {
+        const Value *node;
+        long use_count;   // owners of the root itself, 1 for a caller-held handle
+        size_t reachable; // leaked nodes reachable from it, itself included
+    };
+
+    struct LeakReport
+    {
+        size_t leaked = 0;
+        std::vector<LeakRoot> roots;
+    };
+
+    std::ostream &operator<<(std::ostream &os, const LeakReport &report);
+
+    // Marker for leaks_since(); the number of nodes created so far
+    uint64_t checkpoint();
+    // Always empty unless built with AGRAD_DEBUG_LEAKS
+    LeakReport leaks_since(uint64_t marker);
+
+    namespace detail
+    {
+        inline std::atomic<uint64_t> alive{0};
+        inline std::atomic<uint64_t> created{0};
+        inline std::atomic<uint64_t> peak_alive{0};
+        inline std::atomic<uint64_t> children_bytes{0};
+        inline std::atomic<uint64_t> closure_bytes{0};
+
+        void register_node(const Value *node, uint64_t serial);
+        void unregister_node(const Value *node);
+
+        inline void on_create(const Value *node, size_t children)
+        {
+            uint64_t serial = created.fetch_add(1, std::memory_order_relaxed);
+            uint64_t now = alive.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint64_t peak = peak_alive.load(std::memory_order_relaxed);
+            while (now > peak && !peak_alive.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+            {
+            }
+            children_bytes.fetch_add(children, std::memory_order_relaxed);
+#ifdef AGRAD_DEBUG_LEAKS
+            register_node(node, serial);
+#else
+            (void)node;
+            (void)serial;
+#endif
+        }
+
+        inline void on_destroy(const Value *node, size_t children, size_t closure)
+        {
+            alive.fetch_sub(1, std::memory_order_relaxed);
+            children_bytes.fetch_sub(children, std::memory_order_relaxed);
+            closure_bytes.fetch_sub(closure, std::memory_order_relaxed);
+#ifdef AGRAD_DEBUG_LEAKS
+            unregister_node(node);
+#else
+            (void)node;
+#endif
+        }
+
+        // Signed so a shrinking vector or a smaller closure can be passed as new - old
+        inline void adjust_children(int64_t delta) { children_bytes.fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed); }
+        inline void adjust_closure(int64_t delta) { closure_bytes.fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed); }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Fork-join helpers shared by the loaders, generators and decision-map renderers. Work is
+// split into consecutive ranges, one per thread, with the first range run on the caller.
+namespace agrad
+{
+    // threads = 0 means one per core
+    inline size_t thread_count(size_t threads)
+    {
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Runs fn(t, begin, end) over consecutive ranges covering [0, n), at most one per thread
+    // and each starting on a multiple of grain, so a range never shares a grain-sized block
+    // with another. Returns how many ranges were used; every one of them is called, even
+    // when empty. The first exception thrown by fn is rethrown once all threads are joined.
+    template <typename F>
+    size_t parallel_ranges(size_t n, size_t threads, size_t grain, const F &fn)
+    {
+        grain = std::max<size_t>(1, grain);
+        const size_t blocks = (n + grain - 1) / grain;
+        threads = std::max<size_t>(1, std::min(thread_count(threads), blocks));
+
+        std::vector<std::exception_ptr> errors(threads);
+        auto range = [&](size_t t)
+        {
+            try
+            {
+                fn(t, std::min(n, blocks * t / threads * grain), std::min(n, blocks * (t + 1) / threads * grain));
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (size_t t = 1; t < threads; t++)
+        {
+            workers.emplace_back(range, t);
+        }
+        range(0);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        for (auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        return threads;
+    }
+
+    // Runs fn(0) .. fn(n - 1) on n threads, one of them the caller
+    template <typename F>
+    void parallel_for(size_t n, const F &fn)
+    {
+        parallel_ranges(n, std::max<size_t>(1, n), 1, [&](size_t i, size_t begin, size_t end)
+                        {
+            if (begin < end)
+            {
+                fn(i);
+            } });
+    }
+}
@@ -0,0 +1,172 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace agrad::profiler
+{
+    namespace
+    {
+        // Each thread records into its own table; the lock is only contended while a
+        // snapshot or reset is running
+        struct ThreadTable
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, OpStats> ops;
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadTable>> tables;
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+
+        ThreadTable &local_table()
+        {
+            thread_local std::shared_ptr<ThreadTable> table = []()
+            {
+                auto t = std::make_shared<ThreadTable>();
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                registry().tables.push_back(t);
+                return t;
+            }();
+            return *table;
+        }
+
+        thread_local const char *current_op = nullptr;
+
+        uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    Snapshot snapshot()
+    {
+        Snapshot snap;
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (auto &table : registry().tables)
+        {
+            std::lock_guard<std::mutex> table_lock(table->mutex);
+            for (const auto &[op, stats] : table->ops)
+            {
+                OpStats &total = snap[op];
+                total.nodes += stats.nodes;
+                total.bytes += stats.bytes;
+                total.forward_calls += stats.forward_calls;
+                total.forward_ns += stats.forward_ns;
+                total.backward_calls += stats.backward_calls;
+                total.backward_ns += stats.backward_ns;
+            }
+        }
+        return snap;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (auto &table : registry().tables)
+        {
+            std::lock_guard<std::mutex> table_lock(table->mutex);
+            table->ops.clear();
+        }
+    }
+
+    void print(std::ostream &os, const Snapshot &snap)
+    {
+        std::vector<std::pair<std::string, OpStats>> rows(snap.begin(), snap.end());
+        std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b)
+                  { return a.second.forward_ns + a.second.backward_ns > b.second.forward_ns + b.second.backward_ns; });
+
+        OpStats total;
+        for (const auto &[op, s] : rows)
+        {
+            total.nodes += s.nodes;
+            total.bytes += s.bytes;
+            total.forward_ns += s.forward_ns;
+            total.backward_ns += s.backward_ns;
+        }
+
+        auto line = [&os](const std::string &op, const OpStats &s)
+        {
+            os << std::left << std::setw(14) << op << std::right
+               << std::setw(14) << s.nodes
+               << std::setw(14) << std::fixed << std::setprecision(3) << s.forward_ns / 1e6
+               << std::setw(14) << s.backward_ns / 1e6
+               << std::setw(14) << std::setprecision(1) << s.bytes / 1024.0
+               << std::setw(12) << (s.nodes ? static_cast<double>(s.forward_ns + s.backward_ns) / s.nodes : 0.0)
+               << "\n";
+        };
+
+        os << std::left << std::setw(14) << "op" << std::right
+           << std::setw(14) << "nodes"
+           << std::setw(14) << "forward ms"
+           << std::setw(14) << "backward ms"
+           << std::setw(14) << "KiB"
+           << std::setw(12) << "ns/node"
+           << "\n";
+        os << std::string(82, '-') << "\n";
+        for (const auto &[op, s] : rows)
+        {
+            line(op, s);
+        }
+        os << std::string(82, '-') << "\n";
+        line("total", total);
+        os << std::defaultfloat;
+    }
+
+    void record_node(size_t bytes)
+    {
+        ThreadTable &table = local_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        OpStats &s = table.ops[current_op ? current_op : "leaf"];
+        s.nodes++;
+        s.bytes += bytes;
+    }
+
+    void record_bytes(size_t bytes)
+    {
+        ThreadTable &table = local_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.ops[current_op ? current_op : "leaf"].bytes += bytes;
+    }
+
+    void record_forward(const char *op, uint64_t ns)
+    {
+        ThreadTable &table = local_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        OpStats &s = table.ops[op];
+        s.forward_calls++;
+        s.forward_ns += ns;
+    }
+
+    void record_backward(const std::string &op, uint64_t ns)
+    {
+        ThreadTable &table = local_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        OpStats &s = table.ops[op.empty() ? "(none)" : op];
+        s.backward_calls++;
+        s.backward_ns += ns;
+    }
+
+    ForwardScope::ForwardScope(const char *op) : op(op), previous(current_op), start(std::chrono::steady_clock::now())
+    {
+        current_op = op;
+    }
+
+    ForwardScope::~ForwardScope()
+    {
+        record_forward(op, elapsed_ns(start));
+        current_op = previous;
+    }
+}
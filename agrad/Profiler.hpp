@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Opt-in per-op profiler for the autograd engine. Build with -DAGRAD_PROFILE=ON (which
+// defines AGRAD_ENABLE_PROFILER) to record, for every op type, how many nodes it created,
+// how many bytes they hold and how long its forward and backward passes took. Without it
+// the hooks compile to nothing and snapshot() is always empty.
+namespace agrad::profiler
+{
+    struct OpStats
+    {
+        uint64_t nodes = 0;
+        uint64_t bytes = 0;
+        uint64_t forward_calls = 0;
+        uint64_t forward_ns = 0;
+        uint64_t backward_calls = 0;
+        uint64_t backward_ns = 0;
+    };
+
+    // Op name -> totals, summed over all threads. Nodes created outside any op are "leaf".
+    using Snapshot = std::map<std::string, OpStats>;
+
+    constexpr bool enabled()
+    {
+#ifdef AGRAD_ENABLE_PROFILER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    Snapshot snapshot();
+    void reset();
+
+    // Table of the snapshot sorted by total time, most expensive op first
+    void print(std::ostream &os, const Snapshot &snap);
+    inline void print(std::ostream &os = std::cout) { print(os, snapshot()); }
+
+    // Hooks called by the engine
+    void record_node(size_t bytes);
+    // Memory a node acquired after record_node(), e.g. its backward closure
+    void record_bytes(size_t bytes);
+    void record_forward(const char *op, uint64_t ns);
+    void record_backward(const std::string &op, uint64_t ns);
+
+    // Attributes nodes created during its lifetime to op and times the whole forward call
+    class ForwardScope
+    {
+    private:
+        const char *op;
+        const char *previous;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ForwardScope(const char *op);
+        ~ForwardScope();
+        ForwardScope(const ForwardScope &) = delete;
+        ForwardScope &operator=(const ForwardScope &) = delete;
+    };
+}
+
+#ifdef AGRAD_ENABLE_PROFILER
+#define AGRAD_PROFILE_OP(op) agrad::profiler::ForwardScope agrad_profile_scope_(op)
+#else
+#define AGRAD_PROFILE_OP(op)
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3"). Every output is a pure function of (key, counter), so any
+// element of a random stream can be computed independently, in any order, on any thread.
+class Philox
+{
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+private:
+    static constexpr uint32_t M0 = 0xD2511F53;
+    static constexpr uint32_t M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9;
+    static constexpr uint32_t W1 = 0xBB67AE85;
+
+    static Counter round(const Counter &ctr, const Key &key)
+    {
+        uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+        uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+        return {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+    }
+
+public:
+    static Counter generate(Counter ctr, Key key)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            if (i > 0)
+            {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            ctr = round(ctr, key);
+        }
+        return ctr;
+    }
+
+    // Block `block` of stream `stream` under a 64-bit seed
+    static Counter generate(uint64_t seed, uint64_t stream, uint64_t block)
+    {
+        return generate({static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32),
+                         static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)},
+                        {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)});
+    }
+
+    // Uniform double in [0, 1) from 53 random bits
+    static double to_unit(uint32_t hi, uint32_t lo)
+    {
+        return ((static_cast<uint64_t>(hi) << 21) ^ (lo >> 11)) * 0x1.0p-53;
+    }
+
+    // Fill out[0, n) with uniform doubles in [lo, hi); element i depends only on (seed, stream, i)
+    static void uniform(double *out, size_t n, double lo, double hi, uint64_t seed, uint64_t stream)
+    {
+        for (size_t i = 0; i < n; i += 2)
+        {
+            Counter r = generate(seed, stream, i / 2);
+            out[i] = lo + (hi - lo) * to_unit(r[0], r[1]);
+            if (i + 1 < n)
+            {
+                out[i + 1] = lo + (hi - lo) * to_unit(r[2], r[3]);
+            }
+        }
+    }
+
+    // Fill out[0, n) with normal doubles via Box-Muller, two per block
+    static void normal(double *out, size_t n, double mean, double stddev, uint64_t seed, uint64_t stream)
+    {
+        constexpr double two_pi = 6.283185307179586476925286766559;
+        for (size_t i = 0; i < n; i += 2)
+        {
+            Counter r = generate(seed, stream, i / 2);
+            double u1 = 1.0 - to_unit(r[0], r[1]); // (0, 1], keeps log finite
+            double u2 = to_unit(r[2], r[3]);
+            double radius = std::sqrt(-2.0 * std::log(u1));
+            out[i] = mean + stddev * radius * std::cos(two_pi * u2);
+            if (i + 1 < n)
+            {
+                out[i + 1] = mean + stddev * radius * std::sin(two_pi * u2);
+            }
+        }
+    }
+};
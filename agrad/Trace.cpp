@@ -0,0 +1,204 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace agrad::trace
+{
+    namespace
+    {
+        struct Event
+        {
+            const char *name;
+            const char *category;
+            uint64_t start_ns;
+            uint64_t end_ns;
+            int64_t arg;
+        };
+
+        // Written only by its owning thread; head is published with release so a reader
+        // sees complete events up to it. Once the owner has exited and write() has taken its
+        // events, the buffer is handed to the next thread that registers. exited and written
+        // are guarded by the registry mutex.
+        struct ThreadBuffer
+        {
+            uint32_t tid;
+            std::vector<Event> events;
+            std::atomic<uint64_t> head{0};
+            std::atomic<uint64_t> cleared{0};
+            uint64_t written = 0;
+            bool exited = false;
+
+            ThreadBuffer(uint32_t tid, size_t capacity) : tid(tid), events(capacity) {}
+
+            bool reusable() const
+            {
+                const uint64_t h = head.load(std::memory_order_acquire);
+                return exited && (written >= h || cleared.load(std::memory_order_acquire) >= h);
+            }
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            std::atomic<size_t> capacity{1 << 16};
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+
+        std::shared_ptr<ThreadBuffer> acquire_buffer()
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            const size_t capacity = r.capacity.load();
+            for (auto &b : r.buffers)
+            {
+                if (b->reusable())
+                {
+                    b->events.assign(capacity, Event{});
+                    b->head.store(0, std::memory_order_relaxed);
+                    b->cleared.store(0, std::memory_order_relaxed);
+                    b->written = 0;
+                    b->exited = false;
+                    return b;
+                }
+            }
+            auto b = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(r.buffers.size()), capacity);
+            r.buffers.push_back(b);
+            return b;
+        }
+
+        // Marks the buffer of an exiting thread for reuse
+        struct LocalBuffer
+        {
+            std::shared_ptr<ThreadBuffer> buffer = acquire_buffer();
+
+            ~LocalBuffer()
+            {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                buffer->exited = true;
+            }
+        };
+
+        // Registration takes the lock once per thread; recording never does
+        ThreadBuffer &local_buffer()
+        {
+            thread_local LocalBuffer local;
+            return *local.buffer;
+        }
+    }
+
+    void start(size_t events_per_thread)
+    {
+        if (events_per_thread == 0)
+        {
+            throw std::invalid_argument("Trace buffer needs room for at least one event");
+        }
+        registry().capacity.store(events_per_thread);
+        detail::enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void stop()
+    {
+        detail::enabled.store(false, std::memory_order_relaxed);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (auto &b : registry().buffers)
+        {
+            b->cleared.store(b->head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+
+    void complete(const char *name, const char *category, uint64_t start_ns, uint64_t end_ns, int64_t arg)
+    {
+        ThreadBuffer &b = local_buffer();
+        uint64_t h = b.head.load(std::memory_order_relaxed);
+        b.events[h % b.events.size()] = {name, category, start_ns, end_ns, arg};
+        b.head.store(h + 1, std::memory_order_release);
+    }
+
+    size_t write(const std::string &filename)
+    {
+        std::vector<std::pair<uint32_t, Event>> events;
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            for (auto &b : registry().buffers)
+            {
+                const uint64_t cap = b->events.size();
+                const uint64_t head = b->head.load(std::memory_order_acquire);
+                const uint64_t from = std::max(b->cleared.load(std::memory_order_acquire), head > cap ? head - cap : 0);
+
+                std::vector<Event> copy;
+                copy.reserve(head - from);
+                for (uint64_t i = from; i < head; i++)
+                {
+                    copy.push_back(b->events[i % cap]);
+                }
+
+                // Slots the owner wrote into while we were copying no longer hold event i. While
+                // tracing is on, the slot of the event being recorded right now is suspect too.
+                const uint64_t after = b->head.load(std::memory_order_acquire) + (active() ? 1 : 0);
+                const uint64_t valid_from = std::max(from, after > cap ? after - cap : 0);
+                for (uint64_t i = valid_from; i < head; i++)
+                {
+                    events.emplace_back(b->tid, copy[i - from]);
+                }
+                b->written = head;
+            }
+        }
+
+        std::ofstream out(filename, std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        uint64_t origin = UINT64_MAX;
+        uint32_t threads = 0;
+        for (const auto &[tid, e] : events)
+        {
+            origin = std::min(origin, e.start_ns);
+            threads = std::max(threads, tid + 1);
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"agrad\"}}";
+        for (uint32_t tid = 0; tid < threads; tid++)
+        {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+        }
+
+        char line[512];
+        for (const auto &[tid, e] : events)
+        {
+            int n = std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                                  e.name, e.category, tid, (e.start_ns - origin) / 1e3, (e.end_ns - e.start_ns) / 1e3);
+            out.write(line, n);
+            if (e.arg >= 0)
+            {
+                out << ",\"args\":{\"value\":" << e.arg << "}";
+            }
+            out << "}";
+        }
+        out << "\n]}\n";
+
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing trace: " + filename);
+        }
+        return events.size();
+    }
+}
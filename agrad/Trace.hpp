@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing in the Chrome trace-event format, viewable in chrome://tracing or
+// https://ui.perfetto.dev. Tracing is switched on and off at runtime; while it is off a span
+// costs one relaxed atomic load. Each thread records complete ("X") events into its own
+// fixed-size ring buffer without locking, so the newest events_per_thread spans per thread
+// are kept and older ones are overwritten. The buffer of a thread that has exited is reused
+// by a new thread once write() or clear() has dealt with its events.
+namespace agrad::trace
+{
+    namespace detail
+    {
+        inline std::atomic<bool> enabled{false};
+    }
+
+    // events_per_thread sizes the buffers of threads that start recording afterwards; threads
+    // that already record keep their buffer
+    void start(size_t events_per_thread = 1 << 16);
+    void stop();
+    inline bool active() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    // Drops the events recorded so far
+    void clear();
+
+    // Writes the buffered events as {"traceEvents": [...]} JSON and returns how many were
+    // written. Threads may keep recording meanwhile; events they overwrite are skipped.
+    size_t write(const std::string &filename);
+
+    inline uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Records a span on the calling thread. name and category must outlive the trace, e.g.
+    // string literals; arg is shown in the viewer when it is not negative.
+    void complete(const char *name, const char *category, uint64_t start_ns, uint64_t end_ns, int64_t arg = -1);
+
+    // Span covering the lifetime of the scope
+    class Scope
+    {
+    private:
+        const char *name;
+        const char *category;
+        uint64_t start;
+        int64_t value;
+
+    public:
+        explicit Scope(const char *name, const char *category = "agrad", int64_t arg = -1)
+            : name(active() ? name : nullptr), category(category), start(this->name ? now_ns() : 0), value(arg) {}
+
+        ~Scope()
+        {
+            if (name)
+            {
+                complete(name, category, start, now_ns(), value);
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        void arg(int64_t v) { value = v; }
+    };
+}
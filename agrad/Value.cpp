@@ -1,4 +1,8 @@
 #include "Value.hpp"
+#include "Trace.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
 
 using ValuePtr = std::shared_ptr<Value>;
 
@@ -7,22 +11,21 @@ Value &Value::operator=(const Value &other)
     if (this == &other)
         return *this;
 
+    size_t old_children = children_bytes();
     data = other.data;
     grad = other.grad;
     label = other.label;
-    _backward = other._backward;
     children = other.children;
+    agrad::memory::detail::adjust_children(children_bytes() - old_children);
+    // other's closure refers to other itself, see the copy constructor
+    setBackward(nullptr);
 
     return *this;
 }
 
 ValuePtr Value::operator=(const ValuePtr other)
 {
-    data = other->data;
-    grad = other->grad;
-    label = other->label;
-    _backward = other->_backward;
-    children = other->children;
+    *this = *other;
 
     return shared_from_this();
 }
@@ -42,31 +45,60 @@ void Value::printChildren()
 
 void Value::printChildrenRecursively(int depth)
 {
-    std::string indent(depth * 2, ' ');
-
-    std::cout << "Node[" << label << "] @ " << this << " (data=" << data << ")" << " (grad=" << grad << ")" << std::endl;
-    if (children.empty())
-    {
-        std::cout << indent << "└─ No children\n";
-        return;
-    }
-    for (auto v : children)
+    // Depth-first with an explicit stack; a node reached again through another parent is
+    // printed once more without its children, so shared subgraphs are not repeated
+    std::unordered_set<const Value *> printed;
+    std::vector<std::pair<const Value *, int>> stack{{this, depth}};
+    while (!stack.empty())
     {
-        std::cout << indent << "└─ ";
-        v->printChildrenRecursively(depth + 1);
+        auto [v, d] = stack.back();
+        stack.pop_back();
+
+        std::string indent(d * 2, ' ');
+        if (d > depth)
+        {
+            std::cout << std::string((d - 1) * 2, ' ') << "└─ ";
+        }
+        std::cout << "Node[" << v->label << "] @ " << v << " (data=" << v->data << ")" << " (grad=" << v->grad << ")";
+        if (!printed.insert(v).second)
+        {
+            std::cout << " (see above)\n";
+            continue;
+        }
+        std::cout << std::endl;
+        if (v->children.empty())
+        {
+            std::cout << indent << "└─ No children\n";
+            continue;
+        }
+        for (auto it = v->children.rbegin(); it != v->children.rend(); ++it)
+        {
+            stack.emplace_back(it->get(), d + 1);
+        }
     }
 }
 
 std::vector<std::shared_ptr<Value>> Value::AllChildren()
 {
+    // Breadth-first; childs doubles as the queue
     std::vector<std::shared_ptr<Value>> childs;
-
-    for (auto v : children)
+    std::unordered_set<const Value *> seen{this};
+    for (const auto &v : children)
     {
-        childs.push_back(v);
-
-        auto tmp = v->AllChildren();
-        childs.insert(childs.end(), tmp.begin(), tmp.end());
+        if (seen.insert(v.get()).second)
+        {
+            childs.push_back(v);
+        }
+    }
+    for (size_t i = 0; i < childs.size(); i++)
+    {
+        for (const auto &v : childs[i]->children)
+        {
+            if (seen.insert(v.get()).second)
+            {
+                childs.push_back(v);
+            }
+        }
     }
 
     return childs;
@@ -74,37 +106,171 @@ std::vector<std::shared_ptr<Value>> Value::AllChildren()
 
 void Value::backward()
 {
+    agrad::trace::Scope span("backward_pass", "autograd");
     grad = 1.0;
 
     std::set<ValuePtr> visited;
     std::vector<ValuePtr> topo;
     build_topo(shared_from_this(), visited, topo);
+    span.arg(topo.size());
 
     // Process in reverse order
     for (auto it = topo.rbegin(); it != topo.rend(); ++it)
     {
         if ((*it)->_backward)
         {
+#ifdef AGRAD_ENABLE_PROFILER
+            auto start = std::chrono::steady_clock::now();
+            (*it)->_backward();
+            agrad::profiler::record_backward((*it)->_op, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+#else
             (*it)->_backward();
+#endif
+        }
+    }
+}
+
+namespace
+{
+    double activate(double z, Value::Activation act)
+    {
+        switch (act)
+        {
+        case Value::Activation::ReLU:
+            return z > 0.0 ? z : 0.0;
+        case Value::Activation::Tanh:
+            return std::tanh(z);
+        default:
+            return z;
         }
     }
+
+    // d act / d z, from the saved pre-activation z and the output y = act(z)
+    double activation_grad(double z, double y, Value::Activation act)
+    {
+        switch (act)
+        {
+        case Value::Activation::ReLU:
+            return z > 0.0 ? 1.0 : 0.0;
+        case Value::Activation::Tanh:
+            return 1.0 - y * y;
+        default:
+            return 1.0;
+        }
+    }
+
+    const char *linear_op(Value::Activation act)
+    {
+        switch (act)
+        {
+        case Value::Activation::ReLU:
+            return "linear_relu";
+        case Value::Activation::Tanh:
+            return "linear_tanh";
+        default:
+            return "linear";
+        }
+    }
+}
+
+ValuePtr Value::linear(const std::vector<ValuePtr> &w, const std::vector<ValuePtr> &x, const ValuePtr &b, Activation act)
+{
+    AGRAD_PROFILE_OP(linear_op(act));
+    if (w.size() != x.size())
+    {
+        throw std::invalid_argument("Input size mismatch");
+    }
+
+    const size_t n = w.size();
+    std::vector<ValuePtr> childs;
+    childs.reserve(2 * n + 1);
+    childs.push_back(b);
+    childs.insert(childs.end(), w.begin(), w.end());
+    childs.insert(childs.end(), x.begin(), x.end());
+
+    double z = b->data;
+    for (size_t i = 0; i < n; i++)
+    {
+        z += w[i]->data * x[i]->data;
+    }
+
+    auto a = Value::create(activate(z, act), std::move(childs));
+    a->setOp(linear_op(act));
+
+    // Operands are read back from the node's own children, so the closure stays small and
+    // holds no owning reference to the node
+    Value *node = a.get();
+    a->setBackward([node, n, z, act]()
+                   {
+        const double g = node->grad * activation_grad(z, node->data, act);
+        const auto &c = node->children;
+        c[0]->grad += g;
+        for (size_t i = 0; i < n; i++)
+        {
+            Value *wi = c[1 + i].get();
+            Value *xi = c[1 + n + i].get();
+            wi->grad += g * xi->data;
+            xi->grad += g * wi->data;
+        } });
+
+    return a;
+}
+
+ValuePtr Value::linear(const std::vector<ValuePtr> &w, const std::vector<double> &x, const ValuePtr &b, Activation act)
+{
+    AGRAD_PROFILE_OP(linear_op(act));
+    if (w.size() != x.size())
+    {
+        throw std::invalid_argument("Input size mismatch");
+    }
+
+    const size_t n = w.size();
+    std::vector<ValuePtr> childs;
+    childs.reserve(n + 1);
+    childs.push_back(b);
+    childs.insert(childs.end(), w.begin(), w.end());
+
+    double z = b->data;
+    for (size_t i = 0; i < n; i++)
+    {
+        z += w[i]->data * x[i];
+    }
+
+    auto a = Value::create(activate(z, act), std::move(childs));
+    a->setOp(linear_op(act));
+
+    Value *node = a.get();
+    const size_t x_bytes = x.size() * sizeof(double);
+    a->setBackward([node, x, z, act]()
+                   {
+        const double g = node->grad * activation_grad(z, node->data, act);
+        const auto &c = node->children;
+        c[0]->grad += g;
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            c[1 + i]->grad += g * x[i];
+        } },
+                   x_bytes);
+
+    return a;
 }
 
 ValuePtr Value::relu()
 {
+    AGRAD_PROFILE_OP("relu");
     std::vector<ValuePtr> childs = {shared_from_this()};
     auto a = Value::create(data > 0 ? data : 0, childs);
     a->setOp("relu");
 
-    a->_backward = [this, a]()
-    {
-        this->grad += (this->data > 0.0) * a->grad;
-    };
+    Value *out = a.get();
+    a->setBackward([this, out]()
+                   { this->grad += (this->data > 0.0) * out->grad; });
     return a;
 }
 
 ValuePtr Value::sigmoid()
 {
+    AGRAD_PROFILE_OP("sigm");
     std::function<double(double)> sigm = [](double x)
     {
         return (1.0 / (1.0 + exp(-x)));
@@ -113,69 +279,77 @@ ValuePtr Value::sigmoid()
     auto a = Value::create(sigm(data), childs);
     a->setOp("sigm");
 
-    a->_backward = [this, a]()
-    {
-        this->grad += (a->data * (1.0 - a->data)) * a->grad; // a.data = sigm(this.data)
-    };
+    Value *out = a.get();
+    a->setBackward([this, out]()
+                   { this->grad += (out->data * (1.0 - out->data)) * out->grad; }); // out.data = sigm(this.data)
 
     return a;
 }
 
 ValuePtr Value::tanh()
 {
+    AGRAD_PROFILE_OP("tanh");
     std::vector<ValuePtr> childs = {shared_from_this()};
     auto a = Value::create(std::tanh(data), childs);
     a->setOp("tanh");
 
-    a->_backward = [this, a]()
-    {
-        this->grad += (1.0 - a->data * a->data) * a->grad;
-    };
+    Value *out = a.get();
+    a->setBackward([this, out]()
+                   { this->grad += (1.0 - out->data * out->data) * out->grad; });
 
     return a;
 }
 
 ValuePtr Value::pow(double exponent)
 {
+    AGRAD_PROFILE_OP("pow");
     std::vector<ValuePtr> childs = {shared_from_this()};
     auto a = Value::create(std::pow(data, exponent), childs);
     a->setOp("pow");
 
-    a->_backward = [this, a, exponent]()
-    {
-        this->grad += exponent * std::pow(this->data, exponent - 1) * a->grad;
-    };
+    Value *out = a.get();
+    a->setBackward([this, out, exponent]()
+                   {
+        // Skip std::pow for the common square and identity cases
+        double derivative = exponent == 2.0   ? 2.0 * this->data
+                            : exponent == 1.0 ? 1.0
+                                              : exponent * std::pow(this->data, exponent - 1);
+        this->grad += derivative * out->grad; });
 
     return a;
 }
 
 ValuePtr Value::operator+(ValuePtr other)
 {
+    AGRAD_PROFILE_OP("+");
     std::vector<ValuePtr> childs = {shared_from_this(), other};
     auto a = Value::create(data + other->data, childs);
     a->setOp("+");
 
-    a->_backward = [this, other, a]()
-    {
-        this->grad += a->grad;
-        other->grad += a->grad;
-    };
+    Value *out = a.get();
+    Value *rhs = other.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad;
+        rhs->grad += out->grad; });
     return a;
 }
 
 ValuePtr Value::operator+(double other)
 {
+    AGRAD_PROFILE_OP("+");
     auto otherValue = Value::create(other);
     std::vector<ValuePtr> childs = {shared_from_this(), otherValue};
 
     auto a = Value::create(data + other, childs);
     a->setOp("+");
 
-    a->_backward = [this, a, otherValue]()
-    {
-        this->grad += a->grad;
-        otherValue->grad += a->grad;
-    };
+    Value *out = a.get();
+    Value *rhs = otherValue.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad;
+        rhs->grad += out->grad; });
 
     return a;
 }
@@ -185,7 +359,7 @@ Value &Value::operator+=(double other)
     data += other;
     auto old_backward = _backward;
 
-    _backward = [this, old_backward]()
+    auto new_backward = [this, old_backward]()
     {
         if (old_backward)
         {
@@ -193,6 +367,8 @@ Value &Value::operator+=(double other)
         }
         // Gradient with respect to 'this' remains unchanged
     };
+    // The old closure lives on inside the new one, so its bytes carry over
+    setBackward(std::move(new_backward), backward_bytes);
 
     return *this;
 }
@@ -206,7 +382,7 @@ Value &Value::operator+=(ValuePtr other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, other, old_backward]()
+    auto new_backward = [this, other, old_backward]()
     {
         if (old_backward)
         {
@@ -215,12 +391,13 @@ Value &Value::operator+=(ValuePtr other)
 
         other->grad += this->grad;
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     // Update children to include the other value
     if (std::find_if(children.begin(), children.end(), [&](const std::shared_ptr<Value> &ptr)
                      { return ptr.get() == other.get(); }) == children.end())
     {
-        children.push_back(other);
+        appendChild(other);
     }
 
     _op = "+=";
@@ -229,33 +406,37 @@ Value &Value::operator+=(ValuePtr other)
 
 ValuePtr Value::operator-(ValuePtr other)
 {
+    AGRAD_PROFILE_OP("-");
     std::vector<ValuePtr> childs = {shared_from_this(), other};
     auto a = Value::create(data - other->data, childs);
     a->setOp("-");
     a->setLabel(label + " - " + other->label);
 
-    a->_backward = [this, other, a]()
-    {
-        this->grad += a->grad;
-        other->grad += -a->grad;
-    };
+    Value *out = a.get();
+    Value *rhs = other.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad;
+        rhs->grad += -out->grad; });
 
     return a;
 }
 
 ValuePtr Value::operator-(double other)
 {
+    AGRAD_PROFILE_OP("-");
     auto otherValue = Value::create(other);
     std::vector<ValuePtr> childs = {shared_from_this(), otherValue};
 
     auto a = Value::create(data - other, childs);
     a->setOp("-");
 
-    a->_backward = [this, a, otherValue]()
-    {
-        this->grad += a->grad;
-        otherValue->grad += -a->grad;
-    };
+    Value *out = a.get();
+    Value *rhs = otherValue.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad;
+        rhs->grad += -out->grad; });
 
     return a;
 }
@@ -275,7 +456,7 @@ Value &Value::operator-=(Value &other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, &other, old_backward]()
+    auto new_backward = [this, &other, old_backward]()
     {
         if (old_backward)
         {
@@ -284,13 +465,14 @@ Value &Value::operator-=(Value &other)
 
         other.grad += -this->grad;
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     // Update children to include the other value
     if (std::find_if(children.begin(), children.end(),
                      [&](const std::shared_ptr<Value> &ptr)
                      { return ptr.get() == &other; }) == children.end())
     {
-        children.push_back(std::make_shared<Value>(other));
+        appendChild(std::make_shared<Value>(other));
     }
 
     _op = "-=";
@@ -299,32 +481,36 @@ Value &Value::operator-=(Value &other)
 
 ValuePtr Value::operator*(ValuePtr other)
 {
+    AGRAD_PROFILE_OP("*");
     std::vector<ValuePtr> childs = {shared_from_this(), other};
     auto a = Value::create(data * other->data, childs);
     a->setOp("*");
 
-    a->_backward = [this, other, a]()
-    {
-        this->grad += a->grad * other->data;
-        other->grad += a->grad * this->data;
-    };
+    Value *out = a.get();
+    Value *rhs = other.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad * rhs->data;
+        rhs->grad += out->grad * this->data; });
 
     return a;
 }
 
 ValuePtr Value::operator*(double other)
 {
+    AGRAD_PROFILE_OP("*");
     auto otherValue = Value::create(other);
     std::vector<ValuePtr> childs = {shared_from_this(), otherValue};
     auto a = Value::create(data * other, childs);
     a->setOp("*");
     a->setLabel(label + " * " + std::to_string(other));
 
-    a->_backward = [this, otherValue, a]()
-    {
-        this->grad += a->grad * otherValue->data;
-        otherValue->grad += a->grad * this->data;
-    };
+    Value *out = a.get();
+    Value *rhs = otherValue.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad * rhs->data;
+        rhs->grad += out->grad * this->data; });
 
     return a;
 }
@@ -338,7 +524,7 @@ Value &Value::operator*=(double other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, other, old_backward]()
+    auto new_backward = [this, other, old_backward]()
     {
         this->grad *= other;
 
@@ -347,6 +533,7 @@ Value &Value::operator*=(double other)
             old_backward(); // This handles the gradient for previous operations
         }
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     _op = "*=";
     return *this;
@@ -361,7 +548,7 @@ Value &Value::operator*=(Value &other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, &other, old_backward, old_data]()
+    auto new_backward = [this, &other, old_backward, old_data]()
     {
         this->grad *= other.data;
         other.grad *= old_data;
@@ -371,13 +558,14 @@ Value &Value::operator*=(Value &other)
             old_backward(); // This handles the gradient for previous operations
         }
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     // Update children to include the other value
     if (std::find_if(children.begin(), children.end(),
                      [&](const std::shared_ptr<Value> &ptr)
                      { return ptr.get() == &other; }) == children.end())
     {
-        children.push_back(std::make_shared<Value>(other));
+        appendChild(std::make_shared<Value>(other));
     }
 
     _op = "*=";
@@ -386,21 +574,24 @@ Value &Value::operator*=(Value &other)
 
 ValuePtr Value::operator/(ValuePtr other)
 {
+    AGRAD_PROFILE_OP("/");
     std::vector<ValuePtr> childs = {shared_from_this(), other};
     auto a = Value::create(data / other->data, childs);
     a->setOp("/");
 
-    a->_backward = [this, other, a]()
-    {
-        this->grad += a->grad / other->data;
-        other->grad += -a->grad * this->data / (other->data * other->data);
-    };
+    Value *out = a.get();
+    Value *rhs = other.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad / rhs->data;
+        rhs->grad += -out->grad * this->data / (rhs->data * rhs->data); });
 
     return a;
 }
 
 ValuePtr Value::operator/(double other)
 {
+    AGRAD_PROFILE_OP("/");
     auto otherValue = Value::create(other);
     std::vector<ValuePtr> childs = {shared_from_this(), otherValue};
 
@@ -408,11 +599,12 @@ ValuePtr Value::operator/(double other)
     a->setOp("/");
     a->setLabel(label + " / " + std::to_string(other));
 
-    a->_backward = [this, otherValue, a]()
-    {
-        this->grad += a->grad / otherValue->data;
-        otherValue->grad += -a->grad * this->data / (otherValue->data * otherValue->data);
-    };
+    Value *out = a.get();
+    Value *rhs = otherValue.get();
+    a->setBackward([this, rhs, out]()
+                   {
+        this->grad += out->grad / rhs->data;
+        rhs->grad += -out->grad * this->data / (rhs->data * rhs->data); });
 
     return a;
 }
@@ -426,7 +618,7 @@ Value &Value::operator/=(double other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, other, old_backward]()
+    auto new_backward = [this, other, old_backward]()
     {
         this->grad /= other;
 
@@ -435,6 +627,7 @@ Value &Value::operator/=(double other)
             old_backward(); // This handles the gradient for previous operations
         }
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     _op = "/=";
     return *this;
@@ -449,7 +642,7 @@ Value &Value::operator/=(Value &other)
     auto old_backward = _backward;
 
     // Update backward function to handle both old and new gradients
-    _backward = [this, &other, old_backward, old_data]()
+    auto new_backward = [this, &other, old_backward, old_data]()
     {
         this->grad /= other.data;
         other.grad += -this->grad * old_data / (other.data * other.data); // I'm not sure about this, but doesn't matter much
@@ -459,13 +652,14 @@ Value &Value::operator/=(Value &other)
             old_backward(); // This handles the gradient for previous operations
         }
     };
+    setBackward(std::move(new_backward), backward_bytes);
 
     // Update children to include the other value
     if (std::find_if(children.begin(), children.end(),
                      [&](const std::shared_ptr<Value> &ptr)
                      { return ptr.get() == &other; }) == children.end())
     {
-        children.push_back(std::make_shared<Value>(other));
+        appendChild(std::make_shared<Value>(other));
     }
 
     _op = "/=";
@@ -507,6 +701,7 @@ ValuePtr operator+=(const ValuePtr &lhs, const ValuePtr &rhs)
 
 ValuePtr operator-(const ValuePtr &rhs)
 {
+    AGRAD_PROFILE_OP("neg");
     auto newValue = Value::create(-rhs->getData(), {rhs});
     return newValue;
 }
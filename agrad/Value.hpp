@@ -5,12 +5,22 @@
 #include <memory>
 #include <functional>
 #include <set>
+#include <type_traits>
+#include "Memory.hpp"
+#include "Profiler.hpp"
 
 class Value : public std::enable_shared_from_this<Value>
 {
 public:
     using ValuePtr = std::shared_ptr<Value>;
 
+    enum class Activation
+    {
+        None,
+        ReLU,
+        Tanh,
+    };
+
 private:
     double data;
     double grad;
@@ -18,7 +28,35 @@ private:
     std::function<void()> _backward;
     std::string label;
     std::string _op;
-    void appendChild(ValuePtr a) { children.push_back(a); }
+    size_t backward_bytes = 0; // captured state of _backward, for agrad::memory
+    size_t children_bytes() const { return children.capacity() * sizeof(ValuePtr); }
+    void appendChild(ValuePtr a)
+    {
+        size_t old_bytes = children_bytes();
+        size_t old_total = allocated_bytes();
+        children.push_back(a);
+        agrad::memory::detail::adjust_children(children_bytes() - old_bytes);
+        grown(old_total);
+    }
+    static ValuePtr track(ValuePtr v)
+    {
+#ifdef AGRAD_ENABLE_PROFILER
+        agrad::profiler::record_node(v->allocated_bytes());
+#endif
+        return v;
+    }
+    // Ops fill in the op string, closure etc. after create(), so the profiler gets the
+    // growth of the node once they are set
+    void grown(size_t old_bytes) const
+    {
+#ifdef AGRAD_ENABLE_PROFILER
+        size_t bytes = allocated_bytes();
+        if (bytes > old_bytes)
+        {
+            agrad::profiler::record_bytes(bytes - old_bytes);
+        }
+#endif
+    }
     void build_topo(ValuePtr v, std::set<ValuePtr> &visited, std::vector<ValuePtr> &topo)
     {
         if (visited.find(v) == visited.end())
@@ -33,64 +71,117 @@ private:
     }
 
 public:
-    Value() : data(0.0), grad(0.0), label(""), _op("") {}
-    Value(double value) : data(value), grad(0.0), label(""), _op("") {}
-    Value(double value, std::string label) : data(value), grad(0.0), label(label), _op("") {}
-    Value(double value, std::string label, std::vector<ValuePtr> children) : data(value), grad(0.0), label(label), _backward(nullptr), _op(""), children(children) {}
-    Value(double value, std::vector<ValuePtr> childs) : data(value), grad(0.0), label(""), _op(""), children(childs) {}
-    // Copy constructor
-    Value(const Value &other) : data(other.data), grad(other.grad), label(other.label), _backward(other._backward), _op(other._op), children(other.children) {}
+    Value() : data(0.0), grad(0.0), label(""), _op("") { agrad::memory::detail::on_create(this, 0); }
+    Value(double value) : data(value), grad(0.0), label(""), _op("") { agrad::memory::detail::on_create(this, 0); }
+    Value(double value, std::string label) : data(value), grad(0.0), label(std::move(label)), _op("") { agrad::memory::detail::on_create(this, 0); }
+    Value(double value, std::string label, std::vector<ValuePtr> children) : data(value), grad(0.0), label(label), _backward(nullptr), _op(""), children(children) { agrad::memory::detail::on_create(this, children_bytes()); }
+    Value(double value, std::vector<ValuePtr> childs) : data(value), grad(0.0), label(""), _op(""), children(std::move(childs)) { agrad::memory::detail::on_create(this, children_bytes()); }
+    // Copy constructor; the copy keeps the children but not the backward closure, which
+    // points at the original node, so it is a leaf for backward()
+    Value(const Value &other) : data(other.data), grad(other.grad), label(other.label), _backward(nullptr), _op(other._op), children(other.children)
+    {
+        agrad::memory::detail::on_create(this, children_bytes());
+    }
+    ~Value() { agrad::memory::detail::on_destroy(this, children_bytes(), backward_bytes); }
 
     // copy factory
     static ValuePtr create(ValuePtr other)
     {
-        return std::make_shared<Value>(*other);
+        return track(std::make_shared<Value>(*other));
     }
 
     static ValuePtr create(Value &other)
     {
-        return std::make_shared<Value>(other);
+        return track(std::make_shared<Value>(other));
     }
 
     static ValuePtr create(double value)
     {
-        return std::make_shared<Value>(value);
+        return track(std::make_shared<Value>(value));
     }
 
     static ValuePtr create(double value, std::string label)
     {
-        return std::make_shared<Value>(value, label);
+        return track(std::make_shared<Value>(value, std::move(label)));
     }
 
     static ValuePtr create(double value, std::vector<ValuePtr> children)
     {
-        return std::make_shared<Value>(value, children);
+        return track(std::make_shared<Value>(value, std::move(children)));
     }
 
     static ValuePtr create(double value, std::string label, std::vector<ValuePtr> children)
     {
-        return std::make_shared<Value>(value, label, children);
+        return track(std::make_shared<Value>(value, label, children));
+    }
+
+    // Heap footprint of this node: the object itself, its children list and any
+    // out-of-line label/op strings and the state captured by its backward closure
+    size_t allocated_bytes() const
+    {
+        auto heap = [](const std::string &s)
+        { return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0; };
+        return sizeof(Value) + children_bytes() + backward_bytes + heap(label) + heap(_op);
     }
 
     void backward();
+
+    // act(b + sum(w[i] * x[i])) as a single node; children are b, w... and x...
+    static ValuePtr linear(const std::vector<ValuePtr> &w, const std::vector<ValuePtr> &x, const ValuePtr &b, Activation act);
+    // Same for constant inputs, which get no gradient; children are b and w...
+    static ValuePtr linear(const std::vector<ValuePtr> &w, const std::vector<double> &x, const ValuePtr &b, Activation act);
+
     ValuePtr relu();
     ValuePtr sigmoid();
     ValuePtr tanh();
     ValuePtr pow(double exponent);
 
+    // Every node below this one, once each, nearest first
     std::vector<ValuePtr> AllChildren();
 
-    std::vector<ValuePtr> getChildren() const { return children; }
-    void setChildren(std::vector<ValuePtr> new_children) { children = new_children; }
+    const std::vector<ValuePtr> &getChildren() const { return children; }
+    void setChildren(std::vector<ValuePtr> new_children)
+    {
+        size_t old_bytes = children_bytes();
+        size_t old_total = allocated_bytes();
+        children = std::move(new_children);
+        agrad::memory::detail::adjust_children(children_bytes() - old_bytes);
+        grown(old_total);
+    }
     double getData() const { return data; }
     void setData(double new_data) { data = new_data; }
     double getGrad() const { return grad; }
     void setGrad(double new_grad) { grad = new_grad; }
-    std::string getLabel() const { return label; }
-    void setLabel(std::string new_label) { label = new_label; }
-    std::string getOp() { return _op; }
-    void setOp(std::string new_op) { _op = new_op; }
+    const std::string &getLabel() const { return label; }
+    void setLabel(std::string new_label)
+    {
+        size_t old_bytes = allocated_bytes();
+        label = std::move(new_label);
+        grown(old_bytes);
+    }
+    const std::string &getOp() const { return _op; }
+    void setOp(std::string new_op)
+    {
+        size_t old_bytes = allocated_bytes();
+        _op = std::move(new_op);
+        grown(old_bytes);
+    }
     std::function<void()> getBackward() const { return _backward; }
+    // extra_bytes covers heap memory the closure owns, e.g. captured vectors
+    template <typename F>
+    void setBackward(F &&new_backward, size_t extra_bytes = 0)
+    {
+        size_t bytes = extra_bytes;
+        if constexpr (!std::is_same_v<std::decay_t<F>, std::nullptr_t>)
+        {
+            bytes += sizeof(std::decay_t<F>);
+        }
+        size_t old_bytes = allocated_bytes();
+        agrad::memory::detail::adjust_closure(bytes - backward_bytes);
+        backward_bytes = bytes;
+        _backward = std::forward<F>(new_backward);
+        grown(old_bytes);
+    }
 
     Value &operator=(const Value &other);
     ValuePtr operator=(const ValuePtr other);
@@ -125,7 +216,10 @@ public:
     Value &operator/=(Value &other);
 
     friend std::ostream &operator<<(std::ostream &os, const Value &value);
+    friend agrad::memory::LeakReport agrad::memory::leaks_since(uint64_t marker);
+    friend std::ostream &agrad::memory::operator<<(std::ostream &os, const agrad::memory::LeakReport &report);
     void printChildren();
+    // Tree of the nodes below; a shared node is expanded only the first time
     void printChildrenRecursively(int depth = 0);
 };
 
@@ -1,102 +1,491 @@
 #pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
-#include <set>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <sys/stat.h>
 #include "agrad/Value.hpp"
 
+struct GraphExportOptions
+{
+    std::string rankdir = "LR";
+    size_t max_nodes = 5000;     // nodes written, nearest the root first; 0 writes all
+    bool collapse_chains = true; // fold chains of one op, such as a + b + c + ..., into one node
+    size_t collapse_leaves = 8;  // more leaf inputs than this to one node become one summary; 0 keeps them all
+    bool values = true;          // data and grad rows in node labels
+    int dpi = 96;                // resolution of the rendered png
+};
+
+// What an export wrote, counted in values of the graph
+struct GraphExport
+{
+    size_t nodes = 0;     // values reachable from the root
+    size_t written = 0;   // DOT nodes written for values, a collapsed chain counting once
+    size_t collapsed = 0; // values folded into a chain or leaf summary
+    size_t truncated = 0; // values left out by max_nodes
+};
+
+// Values reachable from a root, numbered in breadth-first order from the root (0). A value
+// with a single consumer always comes after it.
+struct GraphTopology
+{
+    std::vector<Value *> nodes;
+    std::vector<uint32_t> child_begin; // children of nodes[i] are child_ids[child_begin[i], child_begin[i + 1])
+    std::vector<uint32_t> child_ids;
+    std::vector<uint32_t> consumers; // edges into each value; a value used twice by one op counts twice
+    std::vector<uint32_t> parent;    // value that first used each one, the root's being itself
+
+    size_t size() const { return nodes.size(); }
+};
+
+// Shape and size of the graph under a root, gathered in one linear pass
+struct GraphStats
+{
+    struct Op
+    {
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    size_t nodes = 0;
+    size_t edges = 0; // a value used twice by one op counts twice
+    size_t leaves = 0;
+    size_t max_depth = 0;   // edges on the longest path from the root
+    size_t max_fan_in = 0;  // most inputs of one value
+    size_t max_fan_out = 0; // most uses of one value
+    // Values below the root if every shared one were copied per use, which is what a
+    // recursive walk visits; far above nodes means the graph reuses subexpressions heavily
+    double tree_nodes = 0.0;
+    size_t bytes = 0; // heap footprint, from Value::allocated_bytes
+    // Values by number of inputs and of uses: bucket 0 counts 0, bucket b counts [2^(b-1), 2^b)
+    std::vector<size_t> fan_in;
+    std::vector<size_t> fan_out;
+    std::map<std::string, Op> ops; // leaves and other values without an op under "leaf"
+
+    static size_t bucket(size_t count)
+    {
+        size_t b = 0;
+        for (; count > 0; count >>= 1)
+        {
+            b++;
+        }
+        return b;
+    }
+};
+
+inline std::ostream &operator<<(std::ostream &os, const GraphStats &stats)
+{
+    os << "graph: " << stats.nodes << " nodes, " << stats.edges << " edges, " << stats.leaves << " leaves"
+       << ", depth " << stats.max_depth << ", max fan-in " << stats.max_fan_in << ", max fan-out " << stats.max_fan_out
+       << ", " << stats.tree_nodes << " as a tree, " << stats.bytes / 1024.0 << " KiB\n";
+    for (const auto &[op, s] : stats.ops)
+    {
+        os << "  " << op << ": " << s.count << " (" << s.bytes / 1024.0 << " KiB)\n";
+    }
+    return os;
+}
+
 class ValueGraph
 {
 private:
-    static void trace(Value *v, std::set<Value *> &nodes, std::set<Value *> &edges)
+    static constexpr uint32_t none = UINT32_MAX;
+
+    // Single-quotes text for a POSIX shell, so no character in a path is interpreted
+    static std::string shell_quote(std::string_view text)
     {
-        if (!v || nodes.find(v) != nodes.end())
+        std::string quoted = "'";
+        for (char c : text)
         {
-            return;
+            if (c == '\'')
+            {
+                quoted += "'\\''";
+            }
+            else
+            {
+                quoted += c;
+            }
         }
+        return quoted + "'";
+    }
 
-        nodes.insert(v);
-        const auto children = v->getChildren();
-        for (auto child : children)
+    // Escapes the characters that have a meaning in a DOT record label
+    static void write_escaped(std::ostream &out, std::string_view text)
+    {
+        for (char c : text)
         {
-            if (child)
+            switch (c)
             {
-                edges.insert(child.get());
-                trace(child.get(), nodes, edges);
+            case '{':
+            case '}':
+            case '|':
+            case '<':
+            case '>':
+            case '"':
+            case '\\':
+                out.put('\\');
+                out.put(c);
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            default:
+                out.put(c);
             }
         }
     }
 
+    static void write_number(std::ostream &out, double x)
+    {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), x, std::chars_format::fixed, 4);
+        if (result.ec != std::errc())
+        {
+            // Too large for fixed notation
+            result = std::to_chars(buffer, buffer + sizeof(buffer), x);
+        }
+        out.write(buffer, result.ptr - buffer);
+    }
+
 public:
-    static void visualize(Value *root, const std::string &filename, const std::string &rankdir = "LR", const std::string &output_dir = "../graphs/")
+    static GraphTopology collect(Value *root)
     {
+        GraphTopology topology;
         if (!root)
-            return;
+        {
+            topology.child_begin.push_back(0);
+            return topology;
+        }
+
+        std::unordered_map<const Value *, uint32_t> ids;
+        topology.nodes.push_back(root);
+        topology.parent.push_back(0);
+        ids.emplace(root, 0);
+
+        // nodes doubles as the queue
+        for (size_t i = 0; i < topology.nodes.size(); i++)
+        {
+            topology.child_begin.push_back(static_cast<uint32_t>(topology.child_ids.size()));
+            for (const Value::ValuePtr &child : topology.nodes[i]->getChildren())
+            {
+                if (!child)
+                {
+                    continue;
+                }
+                auto [it, inserted] = ids.emplace(child.get(), static_cast<uint32_t>(topology.nodes.size()));
+                if (inserted)
+                {
+                    topology.nodes.push_back(child.get());
+                    topology.parent.push_back(static_cast<uint32_t>(i));
+                }
+                topology.child_ids.push_back(it->second);
+            }
+        }
+        topology.child_begin.push_back(static_cast<uint32_t>(topology.child_ids.size()));
+
+        topology.consumers.assign(topology.nodes.size(), 0);
+        for (uint32_t c : topology.child_ids)
+        {
+            topology.consumers[c]++;
+        }
+        return topology;
+    }
+
+    static GraphStats stats(Value *root)
+    {
+        GraphStats stats;
+        const GraphTopology topology = collect(root);
+        const size_t n = topology.size();
+        stats.nodes = n;
+        stats.edges = topology.child_ids.size();
+        if (n == 0)
+        {
+            return stats;
+        }
+
+        // Longest path and path counts in topological order: a value is taken once all its
+        // consumers are done
+        std::vector<uint32_t> remaining(topology.consumers);
+        std::vector<uint32_t> depth(n, 0);
+        std::vector<double> paths(n, 0.0);
+        std::vector<uint32_t> order{0};
+        order.reserve(n);
+        paths[0] = 1.0;
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            const uint32_t v = order[k];
+            for (uint32_t e = topology.child_begin[v]; e < topology.child_begin[v + 1]; e++)
+            {
+                const uint32_t c = topology.child_ids[e];
+                depth[c] = std::max(depth[c], depth[v] + 1);
+                paths[c] += paths[v];
+                if (--remaining[c] == 0)
+                {
+                    order.push_back(c);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const Value *v = topology.nodes[i];
+            const size_t fan_in = topology.child_begin[i + 1] - topology.child_begin[i];
+            const size_t fan_out = topology.consumers[i];
+            const size_t bytes = v->allocated_bytes();
+
+            stats.leaves += fan_in == 0;
+            stats.max_depth = std::max<size_t>(stats.max_depth, depth[i]);
+            stats.max_fan_in = std::max(stats.max_fan_in, fan_in);
+            stats.max_fan_out = std::max(stats.max_fan_out, fan_out);
+            stats.tree_nodes += i == 0 ? 0.0 : paths[i];
+            stats.bytes += bytes;
+
+            const size_t in_bucket = GraphStats::bucket(fan_in);
+            const size_t out_bucket = GraphStats::bucket(fan_out);
+            if (stats.fan_in.size() <= in_bucket)
+            {
+                stats.fan_in.resize(in_bucket + 1, 0);
+            }
+            if (stats.fan_out.size() <= out_bucket)
+            {
+                stats.fan_out.resize(out_bucket + 1, 0);
+            }
+            stats.fan_in[in_bucket]++;
+            stats.fan_out[out_bucket]++;
+
+            GraphStats::Op &op = stats.ops[v->getOp().empty() ? "leaf" : v->getOp()];
+            op.count++;
+            op.bytes += bytes;
+        }
+        return stats;
+    }
 
-        // check if the output directory exists. If not, create it
-        struct stat info;
-        if (stat(output_dir.c_str(), &info) != 0)
+    // Writes the graph under root as DOT, streaming it to path without holding it in memory.
+    // The traversal is iterative, so graphs of any depth can be exported.
+    static GraphExport write_dot(Value *root, const std::string &path, const GraphExportOptions &options = {})
+    {
+        std::vector<char> buffer(1 << 20);
+        std::ofstream out;
+        out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out)
         {
-            std::string command = "mkdir -p " + output_dir;
-            system(command.c_str());
+            throw std::runtime_error("Unable to open file: " + path);
         }
 
-        std::set<Value *> nodes;
-        std::set<Value *> edges;
-        trace(root, nodes, edges);
+        out << "digraph G {\n";
+        out << "rankdir=" << options.rankdir << ";\n";
+        out << "node [fontsize=12];\n";
 
-        std::stringstream dot;
-        dot << "digraph G {\n";
-        dot << "rankdir=" << rankdir << ";\n";
-        dot << "node [fontsize=12];\n";
+        GraphExport result;
+        const GraphTopology topology = collect(root);
+        const size_t n = topology.size();
+        result.nodes = n;
+        auto children = [&](uint32_t i)
+        {
+            return std::make_pair(topology.child_ids.data() + topology.child_begin[i],
+                                  topology.child_ids.data() + topology.child_begin[i + 1]);
+        };
 
-        for (Value *n : nodes)
+        // A value whose only consumer has the same op joins its consumer's group. Consumers
+        // come first, so their group is already known.
+        std::vector<uint32_t> group(n);
+        for (uint32_t i = 0; i < n; i++)
         {
-            std::string node_id = "n" + std::to_string(reinterpret_cast<std::uintptr_t>(n));
+            group[i] = i;
+            const uint32_t p = topology.parent[i];
+            if (options.collapse_chains && i != 0 && topology.consumers[i] == 1 &&
+                !topology.nodes[i]->getOp().empty() && topology.nodes[i]->getOp() == topology.nodes[p]->getOp())
+            {
+                group[i] = group[p];
+            }
+        }
 
-            // Create three rows: label, data, grad
-            std::string label = n->getLabel();
-            std::stringstream node_label;
-            node_label << "{";
-            if (!label.empty())
+        // Members of each group, in CSR form like the children
+        std::vector<uint32_t> member_begin(n + 1, 0);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            member_begin[group[i] + 1]++;
+        }
+        for (size_t g = 0; g < n; g++)
+        {
+            member_begin[g + 1] += member_begin[g];
+        }
+        std::vector<uint32_t> members(n);
+        {
+            std::vector<uint32_t> next(member_begin.begin(), member_begin.end() - 1);
+            for (uint32_t i = 0; i < n; i++)
             {
-                node_label << label << "|";
+                members[next[group[i]]++] = i;
             }
-            node_label << "data " << std::fixed << std::setprecision(4) << n->getData() << "|"
-                       << "grad " << std::fixed << std::setprecision(4) << n->getGrad()
-                       << "}";
+        }
 
-            dot << node_id << " [shape=record,label=\"" << node_label.str() << "\"];\n";
+        // Leaves used by nothing else are summarized when a group has too many of them
+        auto exclusive_leaf = [&](uint32_t c)
+        {
+            return topology.consumers[c] == 1 && topology.child_begin[c] == topology.child_begin[c + 1];
+        };
+        std::vector<uint32_t> leaves(n, 0);
+        if (options.collapse_leaves > 0)
+        {
+            for (uint32_t c = 1; c < n; c++)
+            {
+                if (exclusive_leaf(c))
+                {
+                    leaves[group[topology.parent[c]]]++;
+                }
+            }
+        }
+        auto summarized = [&](uint32_t g)
+        {
+            return options.collapse_leaves > 0 && leaves[g] > options.collapse_leaves;
+        };
+
+        // Breadth-first from the root over groups until the budget is spent
+        const size_t budget = options.max_nodes == 0 ? n : options.max_nodes;
+        std::vector<uint32_t> queue;
+        std::vector<bool> admitted(n, false);
+        std::vector<uint32_t> stamp(n, none); // last group that drew an edge from each group
+        size_t represented = 0;
+        if (n > 0)
+        {
+            queue.push_back(0);
+            admitted[0] = true;
+        }
+        for (size_t q = 0; q < queue.size(); q++)
+        {
+            const uint32_t g = queue[q];
+            const Value *v = topology.nodes[g];
+            const size_t size = member_begin[g + 1] - member_begin[g];
+            const bool summary = summarized(g);
+            represented += size + (summary ? leaves[g] : 0);
+            result.collapsed += size - 1 + (summary ? leaves[g] : 0);
+            result.written++;
 
-            const auto children = n->getChildren();
-            if (!children.empty() && !n->getOp().empty())
+            out << 'n' << g << " [shape=record,label=\"{";
+            if (!v->getLabel().empty())
+            {
+                write_escaped(out, v->getLabel());
+                if (options.values)
+                {
+                    out << '|';
+                }
+            }
+            if (options.values)
             {
-                std::string op_id = "op" + std::to_string(reinterpret_cast<std::uintptr_t>(n));
-                dot << op_id << " [label=\"" << n->getOp() << "\",shape=circle];\n";
+                out << "data ";
+                write_number(out, v->getData());
+                out << "|grad ";
+                write_number(out, v->getGrad());
+            }
+            out << "}\"];\n";
 
-                // Connect all children to the operation node
-                for (auto child : children)
+            const bool has_inputs = size > 1 || topology.child_begin[g] != topology.child_begin[g + 1];
+            if (!has_inputs)
+            {
+                continue;
+            }
+
+            // Inputs go into an op node, or straight into the value when it has no op
+            std::string target = "n" + std::to_string(g);
+            if (!v->getOp().empty())
+            {
+                target = "op" + std::to_string(g);
+                out << target << " [label=\"";
+                write_escaped(out, v->getOp());
+                if (size > 1)
+                {
+                    out << " \xC3\x97" << size << "\",shape=doublecircle];\n";
+                }
+                else
+                {
+                    out << "\",shape=circle];\n";
+                }
+                out << target << " -> n" << g << ";\n";
+            }
+
+            size_t hidden = 0;
+            for (uint32_t m = member_begin[g]; m < member_begin[g + 1]; m++)
+            {
+                auto [begin, end] = children(members[m]);
+                for (const uint32_t *c = begin; c != end; c++)
                 {
-                    if (child)
+                    const uint32_t h = group[*c];
+                    if (h == g || (summary && exclusive_leaf(*c)) || stamp[h] == g)
+                    {
+                        continue;
+                    }
+                    stamp[h] = g;
+                    if (!admitted[h])
                     {
-                        std::string child_id = "n" + std::to_string(reinterpret_cast<std::uintptr_t>(child.get()));
-                        dot << child_id << " -> " << op_id << ";\n";
+                        if (queue.size() >= budget)
+                        {
+                            hidden++;
+                            continue;
+                        }
+                        admitted[h] = true;
+                        queue.push_back(h);
                     }
+                    out << 'n' << h << " -> " << target << ";\n";
                 }
-                // Connect operation to result
-                dot << op_id << " -> " << node_id << ";\n";
+            }
+            if (summary)
+            {
+                out << 'l' << g << " [label=\"" << leaves[g] << " leaves\",shape=box,style=dashed];\n";
+                out << 'l' << g << " -> " << target << ";\n";
+            }
+            if (hidden > 0)
+            {
+                out << 'm' << g << " [label=\"" << hidden << " more\",shape=plaintext];\n";
+                out << 'm' << g << " -> " << target << " [style=dotted];\n";
             }
         }
+        result.truncated = n - represented;
 
-        dot << "}\n";
-
-        std::ofstream out(output_dir + filename);
-        out << dot.str();
+        out << "}\n";
         out.close();
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing file: " + path);
+        }
+        return result;
+    }
+
+    // Renders the graph under root to output_dir/filename.png with graphviz's dot, laid out
+    // as options.rankdir says. The DOT file is removed once rendered and kept when dot fails.
+    static GraphExport visualize(Value *root, const std::string &filename, const GraphExportOptions &options = {}, const std::string &output_dir = "../graphs/")
+    {
+        if (!root)
+            return {};
+        if (options.dpi <= 0)
+        {
+            throw std::invalid_argument("DPI must be positive");
+        }
+
+        std::filesystem::create_directories(output_dir);
+        const std::string dot_path = (std::filesystem::path(output_dir) / filename).string();
+        GraphExport result = write_dot(root, dot_path, options);
+
+        const std::string command = "dot -Tpng -Gdpi=" + std::to_string(options.dpi) + " " + shell_quote(dot_path) + " -o " + shell_quote(dot_path + ".png");
+        if (std::system(command.c_str()) != 0)
+        {
+            throw std::runtime_error("Failed rendering " + dot_path + " with dot; the DOT file was kept");
+        }
+        std::filesystem::remove(dot_path);
+        return result;
+    }
 
-        system(("dot -Tpng -Gdpi=300 " + output_dir + filename + " -o " + output_dir + filename + ".png").c_str());
-        // remove the .dot file
-        remove((output_dir + filename).c_str());
+    [[deprecated("set GraphExportOptions::rankdir and call visualize(root, filename, options, output_dir)")]]
+    static GraphExport visualize(Value *root, const std::string &filename, const std::string &rankdir, const std::string &output_dir = "../graphs/", GraphExportOptions options = {})
+    {
+        options.rankdir = rankdir;
+        return visualize(root, filename, options, output_dir);
     }
-};
\ No newline at end of file
+};
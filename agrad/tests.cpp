@@ -1,6 +1,15 @@
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "agrad/Loss.hpp"
+#include "agrad/Parallel.hpp"
+#include "agrad/Trace.hpp"
 #include "agrad/Value.hpp"
+#include "agrad/ValueGraph.hpp"
 
 using ValuePtr = std::shared_ptr<Value>;
 
@@ -289,4 +298,578 @@ TEST_F(ValueTest, TopologicalGradient)
     EXPECT_DOUBLE_EQ(a->getGrad(), 2.0);
     EXPECT_DOUBLE_EQ(b->getGrad(), 1.0);
     EXPECT_DOUBLE_EQ(result->getData(), 0.0);
-}
\ No newline at end of file
+}
+
+TEST_F(ValueTest, PowSquare)
+{
+    ValuePtr b = minusV2->pow(2);
+    b->backward();
+    EXPECT_DOUBLE_EQ(b->getData(), 4.0);
+    EXPECT_DOUBLE_EQ(minusV2->getGrad(), -4.0);
+}
+
+TEST_F(ValueTest, MSELoss)
+{
+    ValuePtr loss = agrad::loss::mse({v1, v2}, {0.0, 3.0}); // ((1 - 0)^2 + (2 - 3)^2) / 2 = 1
+    loss->backward();
+    EXPECT_DOUBLE_EQ(loss->getData(), 1.0);
+    EXPECT_EQ(loss->getChildren().size(), 2);
+    EXPECT_DOUBLE_EQ(v1->getGrad(), 1.0);  // 2 * (1 - 0) / 2
+    EXPECT_DOUBLE_EQ(v2->getGrad(), -1.0); // 2 * (2 - 3) / 2
+}
+
+TEST_F(ValueTest, MSELossMatchesGraph)
+{
+    ValuePtr a = Value::create(0.3);
+    ValuePtr b = Value::create(-1.2);
+    ValuePtr graph = ((a - 1.0)->pow(2) + (b + 1.0)->pow(2)) / 2.0;
+    graph->backward();
+    double grad_a = a->getGrad(), grad_b = b->getGrad();
+
+    a->setGrad(0.0);
+    b->setGrad(0.0);
+    ValuePtr fused = agrad::loss::mse({a, b}, {1.0, -1.0});
+    fused->backward();
+    EXPECT_DOUBLE_EQ(fused->getData(), graph->getData());
+    EXPECT_DOUBLE_EQ(a->getGrad(), grad_a);
+    EXPECT_DOUBLE_EQ(b->getGrad(), grad_b);
+}
+
+TEST_F(ValueTest, HingeLoss)
+{
+    // margins: 1 - (1)(2) = -1 -> 0, 1 - (1)(-1) = 2
+    ValuePtr loss = agrad::loss::hinge({v2, minusV1}, {1.0, 1.0});
+    loss->backward();
+    EXPECT_DOUBLE_EQ(loss->getData(), 1.0);
+    EXPECT_DOUBLE_EQ(v2->getGrad(), 0.0);
+    EXPECT_DOUBLE_EQ(minusV1->getGrad(), -0.5);
+}
+
+TEST_F(ValueTest, BCEWithLogitsLoss)
+{
+    ValuePtr loss = agrad::loss::binary_cross_entropy_with_logits({v0}, {1.0});
+    loss->backward();
+    EXPECT_DOUBLE_EQ(loss->getData(), std::log(2.0));
+    EXPECT_DOUBLE_EQ(v0->getGrad(), -0.5); // sigmoid(0) - 1
+
+    // Large logits must not overflow
+    ValuePtr big = Value::create(1000.0);
+    ValuePtr stable = agrad::loss::binary_cross_entropy_with_logits({big}, {0.0});
+    stable->backward();
+    EXPECT_DOUBLE_EQ(stable->getData(), 1000.0);
+    EXPECT_DOUBLE_EQ(big->getGrad(), 1.0);
+}
+
+TEST_F(ValueTest, LossSizeMismatch)
+{
+    EXPECT_THROW(agrad::loss::mse({v1, v2}, {1.0}), std::invalid_argument);
+    EXPECT_THROW(agrad::loss::hinge({}, {}), std::invalid_argument);
+}
+
+TEST_F(ValueTest, LinearMatchesGraph)
+{
+    for (auto act : {Value::Activation::None, Value::Activation::ReLU, Value::Activation::Tanh})
+    {
+        std::vector<ValuePtr> w = {Value::create(0.5), Value::create(-0.25)};
+        std::vector<ValuePtr> x = {Value::create(1.5), Value::create(2.0)};
+        ValuePtr b = Value::create(0.1);
+
+        ValuePtr z = b + w[0] * x[0] + w[1] * x[1];
+        ValuePtr graph = act == Value::Activation::ReLU ? z->relu() : act == Value::Activation::Tanh ? z->tanh() : z;
+        graph->backward();
+        std::vector<double> expected = {b->getGrad(), w[0]->getGrad(), w[1]->getGrad(), x[0]->getGrad(), x[1]->getGrad()};
+
+        for (auto v : {b, w[0], w[1], x[0], x[1]})
+        {
+            v->setGrad(0.0);
+        }
+        ValuePtr fused = Value::linear(w, x, b, act);
+        fused->backward();
+
+        EXPECT_DOUBLE_EQ(fused->getData(), graph->getData());
+        EXPECT_EQ(fused->getChildren().size(), 5);
+        EXPECT_DOUBLE_EQ(b->getGrad(), expected[0]);
+        EXPECT_DOUBLE_EQ(w[0]->getGrad(), expected[1]);
+        EXPECT_DOUBLE_EQ(w[1]->getGrad(), expected[2]);
+        EXPECT_DOUBLE_EQ(x[0]->getGrad(), expected[3]);
+        EXPECT_DOUBLE_EQ(x[1]->getGrad(), expected[4]);
+    }
+}
+
+TEST_F(ValueTest, LinearConstantInputs)
+{
+    std::vector<ValuePtr> w = {v1, minusV2};
+    ValuePtr out = Value::linear(w, std::vector<double>{3.0, 1.0}, v0, Value::Activation::ReLU); // relu(3 - 2) = 1
+    out->backward();
+    EXPECT_DOUBLE_EQ(out->getData(), 1.0);
+    EXPECT_EQ(out->getChildren().size(), 3);
+    EXPECT_DOUBLE_EQ(v0->getGrad(), 1.0);
+    EXPECT_DOUBLE_EQ(v1->getGrad(), 3.0);
+    EXPECT_DOUBLE_EQ(minusV2->getGrad(), 1.0);
+    EXPECT_THROW(Value::linear(w, std::vector<double>{1.0}, v0, Value::Activation::None), std::invalid_argument);
+}
+
+TEST(ProfilerTest, RecordsOps)
+{
+    agrad::profiler::reset();
+    ValuePtr a = Value::create(2.0);
+    ValuePtr b = Value::create(3.0);
+    ValuePtr c = (a * b)->tanh() + a;
+    c->backward();
+    auto snap = agrad::profiler::snapshot();
+
+    if (!agrad::profiler::enabled())
+    {
+        EXPECT_TRUE(snap.empty());
+        return;
+    }
+    EXPECT_EQ(snap["leaf"].nodes, 2);
+    EXPECT_EQ(snap["*"].nodes, 1);
+    EXPECT_EQ(snap["*"].forward_calls, 1);
+    EXPECT_EQ(snap["*"].backward_calls, 1);
+    EXPECT_EQ(snap["tanh"].backward_calls, 1);
+    EXPECT_EQ(snap["+"].nodes, 1);
+    EXPECT_GE(snap["*"].bytes, sizeof(Value) + 2 * sizeof(ValuePtr));
+
+    std::ostringstream table;
+    agrad::profiler::print(table, snap);
+    EXPECT_NE(table.str().find("tanh"), std::string::npos);
+
+    agrad::profiler::reset();
+    EXPECT_EQ(agrad::profiler::snapshot()["*"].nodes, 0);
+}
+
+TEST(ProfilerTest, BytesIncludeClosureAndOp)
+{
+    ValuePtr a = Value::create(2.0, "a");
+    ValuePtr b = Value::create(3.0, "b");
+    agrad::profiler::reset();
+    ValuePtr c = a - b; // also sets a label, so every part of the node is filled in after create()
+    auto snap = agrad::profiler::snapshot();
+
+    if (!agrad::profiler::enabled())
+    {
+        EXPECT_TRUE(snap.empty());
+        return;
+    }
+    EXPECT_EQ(snap["-"].nodes, 1);
+    EXPECT_EQ(snap["-"].bytes, c->allocated_bytes());
+}
+
+TEST(MemoryTest, GraphIsReleased)
+{
+    auto before = agrad::memory::stats();
+    {
+        ValuePtr x = Value::create(0.5);
+        ValuePtr y = ((x * 2.0 + 1.0)->tanh() - x / 3.0)->relu()->pow(2) + x->sigmoid();
+        y->backward();
+
+        auto during = agrad::memory::stats();
+        EXPECT_GT(during.alive, before.alive);
+        EXPECT_GT(during.children_bytes, before.children_bytes);
+        EXPECT_GT(during.closure_bytes, before.closure_bytes);
+        EXPECT_GE(during.peak_alive, during.alive);
+    }
+
+    // Backward closures no longer own their node, so the whole graph goes away with its root
+    auto after = agrad::memory::stats();
+    EXPECT_EQ(after.alive, before.alive);
+    EXPECT_EQ(after.children_bytes, before.children_bytes);
+    EXPECT_EQ(after.closure_bytes, before.closure_bytes);
+    EXPECT_GT(after.created, before.created);
+}
+
+TEST(MemoryTest, FusedNodesAreReleased)
+{
+    auto before = agrad::memory::stats();
+    {
+        std::vector<ValuePtr> w = {Value::create(0.5), Value::create(-0.25)};
+        ValuePtr b = Value::create(0.1);
+        std::vector<ValuePtr> out = {Value::linear(w, std::vector<double>{1.0, 2.0}, b, Value::Activation::Tanh)};
+        agrad::loss::mse(out, {1.0})->backward();
+    }
+    auto after = agrad::memory::stats();
+    EXPECT_EQ(after.alive, before.alive);
+    EXPECT_EQ(after.closure_bytes, before.closure_bytes);
+}
+
+TEST(MemoryTest, CopyOutlivesOriginal)
+{
+    ValuePtr x = Value::create(0.5);
+    ValuePtr c;
+    {
+        ValuePtr t = x->tanh();
+        c = Value::create(t);
+    }
+    // The copy is a leaf: backward must not reach into the destroyed tanh node
+    c->backward();
+    EXPECT_DOUBLE_EQ(c->getData(), std::tanh(0.5));
+    EXPECT_DOUBLE_EQ(c->getGrad(), 1.0);
+    EXPECT_DOUBLE_EQ(x->getGrad(), 0.0);
+    ASSERT_EQ(c->getChildren().size(), 1);
+    EXPECT_EQ(c->getChildren()[0], x);
+
+    Value assigned(0.0);
+    {
+        ValuePtr t = x * 3.0;
+        assigned = *t;
+    }
+    EXPECT_FALSE(assigned.getBackward());
+}
+
+TEST(MemoryTest, LeakReport)
+{
+    ValuePtr a = Value::create(1.0);
+    auto marker = agrad::memory::checkpoint();
+    ValuePtr kept = (a * 2.0)->tanh();
+    auto report = agrad::memory::leaks_since(marker);
+
+    if (!agrad::memory::leak_detection_enabled())
+    {
+        EXPECT_EQ(report.leaked, 0);
+        return;
+    }
+    // tanh, * and the constant 2.0, all reachable from the tanh node
+    EXPECT_EQ(report.leaked, 3);
+    ASSERT_EQ(report.roots.size(), 1);
+    EXPECT_EQ(report.roots[0].node, kept.get());
+    EXPECT_EQ(report.roots[0].use_count, 1);
+    EXPECT_EQ(report.roots[0].reachable, 3);
+
+    kept.reset();
+    EXPECT_EQ(agrad::memory::leaks_since(marker).leaked, 0);
+}
+
+TEST(MemoryTest, LeakReportKeepsCyclesNextToRoots)
+{
+    ValuePtr a = Value::create(1.0);
+    auto marker = agrad::memory::checkpoint();
+    ValuePtr kept = (a * 2.0)->tanh();
+    ValuePtr p = Value::create(3.0);
+    ValuePtr q = Value::create(4.0, {p});
+    p->setChildren({q});
+    const Value *p_node = p.get();
+    const Value *q_node = q.get();
+    p.reset();
+    q.reset();
+
+    auto report = agrad::memory::leaks_since(marker);
+    if (agrad::memory::leak_detection_enabled())
+    {
+        // The tanh root plus one entry for each member of the p <-> q cycle
+        EXPECT_EQ(report.leaked, 5);
+        ASSERT_EQ(report.roots.size(), 3);
+        EXPECT_EQ(report.roots[0].node, kept.get());
+        std::set<const Value *> cycle = {report.roots[1].node, report.roots[2].node};
+        EXPECT_EQ(cycle, (std::set<const Value *>{p_node, q_node}));
+    }
+    else
+    {
+        EXPECT_EQ(report.leaked, 0);
+    }
+
+    // Break the cycle so the nodes go away
+    std::const_pointer_cast<Value>(p_node->shared_from_this())->setChildren({});
+}
+
+TEST(TraceTest, WritesChromeTrace)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_trace_test.json").string();
+    agrad::trace::clear();
+
+    {
+        agrad::trace::Scope ignored("ignored");
+    }
+    agrad::trace::start();
+    {
+        agrad::trace::Scope span("outer", "test", 7);
+        (Value::create(1.0) * 2.0)->backward();
+    }
+    std::thread([]()
+                { agrad::trace::Scope span("worker", "test"); })
+        .join();
+    agrad::trace::stop();
+
+    EXPECT_EQ(agrad::trace::write(path), 3); // outer, backward_pass, worker
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0);
+    EXPECT_NE(json.find("\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"value\":7}"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"backward_pass\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"worker\""), std::string::npos);
+    EXPECT_EQ(json.find("ignored"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+
+    agrad::trace::clear();
+    EXPECT_EQ(agrad::trace::write(path), 0);
+    std::filesystem::remove(path);
+}
+
+TEST(TraceTest, RingBufferKeepsNewest)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_trace_ring.json").string();
+    // A fresh thread gets a buffer of the size passed to start()
+    std::thread([&]()
+                {
+        agrad::trace::clear();
+        agrad::trace::start(4);
+        for (int i = 0; i < 10; i++)
+        {
+            agrad::trace::Scope span("tick", "test", i);
+        }
+        agrad::trace::stop(); })
+        .join();
+
+    EXPECT_EQ(agrad::trace::write(path), 4);
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(json.find("\"value\":5}"), std::string::npos);
+    EXPECT_NE(json.find("\"value\":6}"), std::string::npos);
+    EXPECT_NE(json.find("\"value\":9}"), std::string::npos);
+
+    agrad::trace::clear();
+    agrad::trace::start();
+    agrad::trace::stop();
+    std::filesystem::remove(path);
+}
+
+TEST(TraceTest, ReusesBuffersOfExitedThreads)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_trace_reuse.json").string();
+    agrad::trace::clear();
+    agrad::trace::start();
+
+    std::vector<std::string> tids;
+    for (int round = 0; round < 4; round++)
+    {
+        std::thread([]()
+                    { agrad::trace::Scope span("short_lived", "test"); })
+            .join();
+        EXPECT_EQ(agrad::trace::write(path), 1);
+
+        std::ifstream in(path);
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        size_t at = json.find("\"tid\":", json.find("\"name\":\"short_lived\""));
+        ASSERT_NE(at, std::string::npos);
+        tids.push_back(json.substr(at, json.find(',', at) - at));
+    }
+    agrad::trace::stop();
+
+    // Every thread after the first records into the buffer its drained predecessor left
+    for (size_t i = 1; i < tids.size(); i++)
+    {
+        EXPECT_EQ(tids[i], tids[0]);
+    }
+
+    agrad::trace::clear();
+    std::filesystem::remove(path);
+}
+
+TEST(ParallelTest, RangesCoverInput)
+{
+    std::vector<std::pair<size_t, size_t>> ranges(4);
+    size_t used = agrad::parallel_ranges(100, 4, 16, [&](size_t t, size_t begin, size_t end)
+                                         { ranges[t] = {begin, end}; });
+    ASSERT_EQ(used, 4);
+    EXPECT_EQ(ranges.front().first, 0);
+    EXPECT_EQ(ranges.back().second, 100);
+    for (size_t t = 0; t < used; t++)
+    {
+        EXPECT_EQ(ranges[t].first % 16, 0);
+        if (t > 0)
+        {
+            EXPECT_EQ(ranges[t].first, ranges[t - 1].second);
+        }
+    }
+
+    // Never more ranges than grain-sized blocks
+    EXPECT_EQ(agrad::parallel_ranges(20, 8, 16, [](size_t, size_t, size_t) {}), 2);
+    EXPECT_EQ(agrad::parallel_ranges(0, 8, 1, [](size_t, size_t, size_t) {}), 1);
+
+    std::vector<int> hits(5, 0);
+    agrad::parallel_for(5, [&](size_t i)
+                        { hits[i]++; });
+    EXPECT_EQ(hits, std::vector<int>(5, 1));
+
+    EXPECT_THROW(agrad::parallel_ranges(10, 2, 1, [](size_t t, size_t, size_t)
+                                        { if (t == 1) throw std::runtime_error("worker"); }),
+                 std::runtime_error);
+}
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream in(path);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST(ValueGraphTest, CollapsesChains)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_graph_small.dot").string();
+    auto x1 = Value::create(2.0, "x1");
+    auto x2 = Value::create(0.0, "x2");
+    auto w1 = Value::create(-3.0, "w1");
+    auto w2 = Value::create(1.0, "w2");
+    auto b = Value::create(6.5, "b|{bias}");
+    auto o = (x1 * w1 + x2 * w2 + b)->tanh();
+    o->setLabel("output");
+
+    // The two additions become one node; everything else is written as it is
+    GraphExport result = ValueGraph::write_dot(o.get(), path);
+    EXPECT_EQ(result.nodes, 10);
+    EXPECT_EQ(result.written, 9);
+    EXPECT_EQ(result.collapsed, 1);
+    EXPECT_EQ(result.truncated, 0);
+
+    std::string dot = read_file(path);
+    EXPECT_EQ(dot.rfind("digraph G {\nrankdir=LR;\n", 0), 0);
+    EXPECT_NE(dot.find("n0 [shape=record,label=\"{output|data 0.4621|grad 0.0000}\"];"), std::string::npos);
+    EXPECT_NE(dot.find("label=\"+ \xC3\x97" "2\",shape=doublecircle"), std::string::npos);
+    EXPECT_NE(dot.find("{b\\|\\{bias\\}|data 6.5000|grad 0.0000}"), std::string::npos);
+    EXPECT_EQ(dot.substr(dot.size() - 2), "}\n");
+
+    GraphExportOptions options;
+    options.collapse_chains = false;
+    options.values = false;
+    result = ValueGraph::write_dot(o.get(), path, options);
+    EXPECT_EQ(result.written, 10);
+    EXPECT_EQ(result.collapsed, 0);
+    EXPECT_EQ(read_file(path).find("data"), std::string::npos);
+    std::filesystem::remove(path);
+}
+
+TEST(ValueGraphTest, VisualizeQuotesPaths)
+{
+    auto dir = std::filesystem::temp_directory_path() / "agrad graph \"$(touch agrad_injected)\" `x` 'q'";
+    std::filesystem::remove_all(dir);
+    auto o = Value::create(1.0, "a") * 2.0;
+    GraphExportOptions options;
+    options.rankdir = "TB";
+
+    bool rendered = true;
+    try
+    {
+        ValueGraph::visualize(o.get(), "graph", options, dir.string());
+    }
+    catch (const std::runtime_error &)
+    {
+        rendered = false; // no graphviz here; the DOT file is kept
+    }
+
+    // The path reached dot as one argument, so nothing in it was run by the shell
+    EXPECT_FALSE(std::filesystem::exists("agrad_injected"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "agrad_injected"));
+    if (rendered)
+    {
+        EXPECT_TRUE(std::filesystem::exists(dir / "graph.png"));
+    }
+    else
+    {
+        EXPECT_EQ(read_file((dir / "graph").string()).rfind("digraph G {\nrankdir=TB;\n", 0), 0);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ValueGraphTest, DeepChainAndNodeLimit)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_graph_deep.dot").string();
+    const size_t n = 200000;
+
+    // Held from the root down so the chain is released without recursing through it
+    std::vector<ValuePtr> chain{Value::create(0.0)};
+    for (size_t i = 0; i < n; i++)
+    {
+        chain.push_back(chain.back() + Value::create(1.0));
+    }
+
+    // One node for the additions and one summary for their leaves
+    GraphExport result = ValueGraph::write_dot(chain.back().get(), path);
+    EXPECT_EQ(result.nodes, 2 * n + 1);
+    EXPECT_EQ(result.written, 1);
+    EXPECT_EQ(result.collapsed, 2 * n);
+    EXPECT_EQ(result.truncated, 0);
+    std::string dot = read_file(path);
+    EXPECT_NE(dot.find("+ \xC3\x97" "200000"), std::string::npos);
+    EXPECT_NE(dot.find("l0 [label=\"200001 leaves\",shape=box,style=dashed];"), std::string::npos);
+
+    // Without collapsing, the budget keeps the nodes nearest the root
+    GraphExportOptions options;
+    options.collapse_chains = false;
+    options.collapse_leaves = 0;
+    options.max_nodes = 100;
+    result = ValueGraph::write_dot(chain.back().get(), path, options);
+    EXPECT_EQ(result.written, 100);
+    EXPECT_EQ(result.collapsed, 0);
+    EXPECT_EQ(result.truncated, 2 * n + 1 - 100);
+    dot = read_file(path);
+    EXPECT_NE(dot.find(" more\",shape=plaintext];"), std::string::npos);
+    EXPECT_EQ(dot.find("n100 "), std::string::npos);
+
+    while (!chain.empty())
+    {
+        chain.pop_back();
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ValueGraphTest, Topology)
+{
+    auto a = Value::create(2.0);
+    auto b = a * a;
+    auto c = b + a;
+
+    GraphTopology topology = ValueGraph::collect(c.get());
+    ASSERT_EQ(topology.size(), 3);
+    EXPECT_EQ(topology.nodes[0], c.get());
+    EXPECT_EQ(topology.nodes[1], b.get());
+    EXPECT_EQ(topology.nodes[2], a.get());
+    EXPECT_EQ(topology.child_ids, (std::vector<uint32_t>{1, 2, 2, 2}));
+    EXPECT_EQ(topology.child_begin, (std::vector<uint32_t>{0, 2, 4, 4}));
+    EXPECT_EQ(topology.consumers, (std::vector<uint32_t>{0, 1, 3}));
+    EXPECT_EQ(ValueGraph::collect(nullptr).size(), 0);
+}
+
+TEST(ValueGraphTest, StatsOnSharedGraph)
+{
+    // Every square uses the previous value twice, so a recursive walk would visit 2^64 nodes
+    const size_t levels = 64;
+    ValuePtr x = Value::create(1.0, "x");
+    ValuePtr y = x;
+    for (size_t i = 0; i < levels; i++)
+    {
+        y = y * y;
+    }
+    ValuePtr root = y + x;
+
+    GraphStats stats = ValueGraph::stats(root.get());
+    EXPECT_EQ(stats.nodes, levels + 2);
+    EXPECT_EQ(stats.edges, 2 * levels + 2);
+    EXPECT_EQ(stats.leaves, 1);
+    EXPECT_EQ(stats.max_depth, levels + 1);
+    EXPECT_EQ(stats.max_fan_in, 2);
+    EXPECT_EQ(stats.max_fan_out, 3);
+    EXPECT_DOUBLE_EQ(stats.tree_nodes, std::ldexp(1.0, levels + 1));
+    EXPECT_EQ(stats.fan_in, (std::vector<size_t>{1, 0, levels + 1}));
+    EXPECT_EQ(stats.fan_out, (std::vector<size_t>{1, 1, levels}));
+    ASSERT_EQ(stats.ops.size(), 3);
+    EXPECT_EQ(stats.ops["*"].count, levels);
+    EXPECT_EQ(stats.ops["+"].count, 1);
+    EXPECT_EQ(stats.ops["leaf"].count, 1);
+    EXPECT_EQ(stats.ops["*"].bytes, levels * y->allocated_bytes());
+
+    size_t bytes = 0;
+    for (const auto &[op, s] : stats.ops)
+    {
+        bytes += s.bytes;
+    }
+    EXPECT_EQ(stats.bytes, bytes);
+    EXPECT_EQ(ValueGraph::stats(nullptr).nodes, 0);
+
+    // The other walks over the graph see each node once as well
+    EXPECT_EQ(root->AllChildren().size(), levels + 1);
+    testing::internal::CaptureStdout();
+    root->printChildrenRecursively();
+    std::string printed = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(std::count(printed.begin(), printed.end(), '\n'), 2 * levels + 4);
+    EXPECT_EQ(printed.rfind("Node[] @ ", 0), 0);
+}
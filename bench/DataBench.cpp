@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "data/BatchLoader.hpp"
+#include "data/BinaryDataset.hpp"
+
+// Writes (once per run) a CSV in the format load_dataset expects and returns its path. The
+// file is written under a temporary name and renamed when complete, so an interrupted run
+// never leaves a truncated file behind for the next one to measure.
+static std::string generated_csv(size_t rows)
+{
+    auto path = std::filesystem::temp_directory_path() / ("agrad_bench_" + std::to_string(rows) + ".csv");
+    if (std::filesystem::exists(path))
+    {
+        return path.string();
+    }
+
+    auto partial = path;
+    partial += ".partial";
+    {
+        std::ofstream out(partial, std::ios::trunc);
+        out << "x1,x2,label\n";
+        out << std::scientific << std::setprecision(18);
+        for (size_t i = 0; i < rows; i++)
+        {
+            double x1 = std::cos(0.001 * i);
+            double x2 = std::sin(0.0007 * i);
+            out << x1 << "," << x2 << "," << (x1 * x2 > 0 ? "1.0" : "-1.0") << "\n";
+        }
+        if (!out.flush())
+        {
+            std::filesystem::remove(partial);
+            throw std::runtime_error("Failed writing benchmark data: " + partial.string());
+        }
+    }
+    std::filesystem::rename(partial, path);
+    return path.string();
+}
+
+static void BM_LoadDataset(benchmark::State &state)
+{
+    const size_t rows = state.range(0);
+    const std::string path = generated_csv(rows);
+    for (auto _ : state)
+    {
+        Dataset dataset = DataLoader::load_dataset(path);
+        benchmark::DoNotOptimize(dataset.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+}
+BENCHMARK(BM_LoadDataset)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+// 10^7 rows split over the given number of threads
+static void BM_LoadDatasetThreads(benchmark::State &state)
+{
+    const std::string path = generated_csv(10000000);
+    for (auto _ : state)
+    {
+        Dataset dataset = DataLoader::load_dataset(path, {}, state.range(0));
+        benchmark::DoNotOptimize(dataset.data());
+    }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+}
+BENCHMARK(BM_LoadDatasetThreads)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Mapping the converted file and reading every row, for comparison with BM_LoadDataset
+static void BM_LoadBinary(benchmark::State &state)
+{
+    const size_t rows = state.range(0);
+    const std::string path = generated_csv(rows) + ".bin";
+    BinaryDataset::convert_csv(generated_csv(rows), path);
+    for (auto _ : state)
+    {
+        Dataset dataset = BinaryDataset::load(path);
+        double sum = 0.0;
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            sum += dataset.row(i)[0] + dataset.label(i);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+}
+BENCHMARK(BM_LoadBinary)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+static void BM_TrainTestSplit(benchmark::State &state)
+{
+    const size_t rows = state.range(0);
+    Dataset dataset = DataLoader::load_dataset(generated_csv(rows));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DataLoader::train_test_split(dataset, 0.8));
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_TrainTestSplit)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// One shuffled epoch of batches of 32; the argument is the number of worker threads
+static void BM_BatchLoaderEpoch(benchmark::State &state)
+{
+    Dataset dataset = DataLoader::load_dataset(generated_csv(100000));
+    BatchLoaderOptions options;
+    options.workers = state.range(0);
+    BatchLoader loader(dataset, options);
+    for (auto _ : state)
+    {
+        for (const MiniBatch &batch : loader)
+        {
+            benchmark::DoNotOptimize(batch.x.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * dataset.size());
+}
+BENCHMARK(BM_BatchLoaderEpoch)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
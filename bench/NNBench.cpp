@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+#include "agrad/Loss.hpp"
+#include "nn/DecisionMap.hpp"
+#include "nn/MLP.hpp"
+
+static std::vector<double> make_input(size_t n)
+{
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = std::sin(0.1 * i);
+    }
+    return x;
+}
+
+static void BM_NeuronForward(benchmark::State &state)
+{
+    const int width = state.range(0);
+    Neuron neuron(width, true);
+    auto x = make_input(width);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(neuron(x));
+    }
+    state.SetItemsProcessed(state.iterations() * width);
+}
+BENCHMARK(BM_NeuronForward)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_NeuronBackward(benchmark::State &state)
+{
+    const int width = state.range(0);
+    Neuron neuron(width, true);
+    auto x = make_input(width);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto out = neuron(x);
+        state.ResumeTiming();
+        out->backward();
+    }
+    state.SetItemsProcessed(state.iterations() * width);
+}
+BENCHMARK(BM_NeuronBackward)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_LayerForward(benchmark::State &state)
+{
+    const int width = state.range(0);
+    Layer layer(width, width, true);
+    auto x = make_input(width);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(layer(x));
+    }
+    state.SetItemsProcessed(state.iterations() * width * width);
+}
+BENCHMARK(BM_LayerForward)->RangeMultiplier(4)->Range(16, 256);
+
+static void BM_LayerBackward(benchmark::State &state)
+{
+    const int width = state.range(0);
+    Layer layer(width, width, true);
+    auto x = make_input(width);
+    std::vector<double> targets(width, 0.5);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto loss = agrad::loss::mse(layer(x), targets);
+        state.ResumeTiming();
+        loss->backward();
+    }
+    state.SetItemsProcessed(state.iterations() * width * width);
+}
+BENCHMARK(BM_LayerBackward)->RangeMultiplier(4)->Range(16, 256);
+
+static void BM_MLPForward(benchmark::State &state)
+{
+    const int width = state.range(0);
+    MLP model(2, {width, width, 1}, false);
+    auto x = make_input(2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(model(x));
+    }
+}
+BENCHMARK(BM_MLPForward)->RangeMultiplier(4)->Range(16, 256);
+
+// One training step: forward, loss, zero_grad and backward over a batch
+static void BM_MLPTrainStep(benchmark::State &state)
+{
+    const int width = state.range(0);
+    const int batch = state.range(1);
+    MLP model(2, {width, width, 1}, false);
+    std::vector<std::vector<double>> x(batch, make_input(2));
+    std::vector<double> y(batch, 1.0);
+    for (auto _ : state)
+    {
+        auto loss = agrad::loss::mse(model(x), y);
+        model.zero_grad();
+        loss->backward();
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_MLPTrainStep)->ArgsProduct({{16, 64, 256}, {1, 32}});
+
+static void BM_FrozenPredict(benchmark::State &state)
+{
+    const int width = state.range(0);
+    const size_t n = 1024;
+    MLP model(2, {width, width, 1}, false);
+    auto frozen = model.freeze();
+    auto x = make_input(2 * n);
+    std::vector<double> out(n);
+    for (auto _ : state)
+    {
+        frozen.predict(x.data(), n, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_FrozenPredict)->RangeMultiplier(4)->Range(16, 256);
+
+static void BM_DecisionMap(benchmark::State &state)
+{
+    const size_t side = state.range(0);
+    MLP model(2, {16, 16, 1}, false);
+    auto frozen = model.freeze();
+    const DecisionGrid grid = DecisionGrid::with_size(-2.0, 3.0, -1.5, 2.0, side, side);
+    for (auto _ : state)
+    {
+        auto map = DecisionMap::evaluate(frozen, grid, state.range(1));
+        benchmark::DoNotOptimize(map.data());
+    }
+    state.SetItemsProcessed(state.iterations() * grid.size());
+}
+BENCHMARK(BM_DecisionMap)->ArgsProduct({{500, 2000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_DecisionMapAdaptive(benchmark::State &state)
+{
+    const size_t side = state.range(0);
+    MLP model(2, {16, 16, 1}, false);
+    auto frozen = model.freeze();
+    const DecisionGrid grid = DecisionGrid::with_size(-2.0, 3.0, -1.5, 2.0, side, side);
+    size_t evaluations = 0;
+    for (auto _ : state)
+    {
+        auto map = DecisionMap::adaptive(frozen, grid, 16, 1);
+        evaluations = map.getEvaluations();
+        benchmark::DoNotOptimize(map.data());
+    }
+    state.counters["evaluated"] = static_cast<double>(evaluations) / grid.size();
+    state.SetItemsProcessed(state.iterations() * grid.size());
+}
+BENCHMARK(BM_DecisionMapAdaptive)->Arg(500)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_Parameters(benchmark::State &state)
+{
+    const int width = state.range(0);
+    MLP model(2, {width, width, 1}, false);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.parameters());
+    }
+}
+BENCHMARK(BM_Parameters)->RangeMultiplier(4)->Range(16, 256);
+
+static void BM_ZeroGrad(benchmark::State &state)
+{
+    const int width = state.range(0);
+    MLP model(2, {width, width, 1}, false);
+    for (auto _ : state)
+    {
+        model.zero_grad();
+    }
+}
+BENCHMARK(BM_ZeroGrad)->RangeMultiplier(4)->Range(16, 256);
@@ -0,0 +1,151 @@
+#include <benchmark/benchmark.h>
+#include "agrad/Loss.hpp"
+#include "agrad/Value.hpp"
+
+using ValuePtr = Value::ValuePtr;
+
+// Forward cost of a single op on two leaves
+template <typename Op>
+static void forward_op(benchmark::State &state, Op op)
+{
+    ValuePtr a = Value::create(0.7);
+    ValuePtr b = Value::create(1.3);
+    for (auto _ : state)
+    {
+        ValuePtr c = op(a, b);
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+// Backward cost of a single op, graph construction excluded
+template <typename Op>
+static void backward_op(benchmark::State &state, Op op)
+{
+    ValuePtr a = Value::create(0.7);
+    ValuePtr b = Value::create(1.3);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ValuePtr c = op(a, b);
+        state.ResumeTiming();
+        c->backward();
+        benchmark::DoNotOptimize(a->getGrad());
+    }
+}
+
+static ValuePtr op_add(const ValuePtr &a, const ValuePtr &b) { return a + b; }
+static ValuePtr op_sub(const ValuePtr &a, const ValuePtr &b) { return a - b; }
+static ValuePtr op_mul(const ValuePtr &a, const ValuePtr &b) { return a * b; }
+static ValuePtr op_div(const ValuePtr &a, const ValuePtr &b) { return a / b; }
+static ValuePtr op_relu(const ValuePtr &a, const ValuePtr &) { return a->relu(); }
+static ValuePtr op_tanh(const ValuePtr &a, const ValuePtr &) { return a->tanh(); }
+static ValuePtr op_sigmoid(const ValuePtr &a, const ValuePtr &) { return a->sigmoid(); }
+static ValuePtr op_pow2(const ValuePtr &a, const ValuePtr &) { return a->pow(2); }
+static ValuePtr op_pow3(const ValuePtr &a, const ValuePtr &) { return a->pow(3); }
+
+BENCHMARK_CAPTURE(forward_op, add, op_add);
+BENCHMARK_CAPTURE(forward_op, sub, op_sub);
+BENCHMARK_CAPTURE(forward_op, mul, op_mul);
+BENCHMARK_CAPTURE(forward_op, div, op_div);
+BENCHMARK_CAPTURE(forward_op, relu, op_relu);
+BENCHMARK_CAPTURE(forward_op, tanh, op_tanh);
+BENCHMARK_CAPTURE(forward_op, sigmoid, op_sigmoid);
+BENCHMARK_CAPTURE(forward_op, pow2, op_pow2);
+BENCHMARK_CAPTURE(forward_op, pow3, op_pow3);
+
+BENCHMARK_CAPTURE(backward_op, add, op_add);
+BENCHMARK_CAPTURE(backward_op, sub, op_sub);
+BENCHMARK_CAPTURE(backward_op, mul, op_mul);
+BENCHMARK_CAPTURE(backward_op, div, op_div);
+BENCHMARK_CAPTURE(backward_op, relu, op_relu);
+BENCHMARK_CAPTURE(backward_op, tanh, op_tanh);
+BENCHMARK_CAPTURE(backward_op, sigmoid, op_sigmoid);
+BENCHMARK_CAPTURE(backward_op, pow2, op_pow2);
+BENCHMARK_CAPTURE(backward_op, pow3, op_pow3);
+
+// act(w . x + b) over n inputs as one fused node
+static void BM_LinearForward(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<ValuePtr> w, x;
+    for (size_t i = 0; i < n; i++)
+    {
+        w.push_back(Value::create(0.01 * i));
+        x.push_back(Value::create(1.0));
+    }
+    ValuePtr b = Value::create(0.0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Value::linear(w, x, b, Value::Activation::Tanh));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_LinearForward)->RangeMultiplier(4)->Range(4, 1024);
+
+// Backward through a chain x -> x * c + c -> ... of the given depth
+static void BM_BackwardDeepChain(benchmark::State &state)
+{
+    const size_t depth = state.range(0);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ValuePtr x = Value::create(1.0);
+        ValuePtr out = x;
+        for (size_t i = 0; i < depth; i++)
+        {
+            out = out * 0.999 + 0.001;
+        }
+        state.ResumeTiming();
+        out->backward();
+        benchmark::DoNotOptimize(x->getGrad());
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_BackwardDeepChain)->RangeMultiplier(10)->Range(10, 10000);
+
+// Backward through one node with n children (a fused batch loss)
+static void BM_BackwardWideFanIn(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<ValuePtr> predictions;
+    for (size_t i = 0; i < n; i++)
+    {
+        predictions.push_back(Value::create(0.001 * i));
+    }
+    std::vector<double> targets(n, 1.0);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ValuePtr loss = agrad::loss::mse(predictions, targets);
+        state.ResumeTiming();
+        loss->backward();
+        benchmark::DoNotOptimize(predictions[0]->getGrad());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BackwardWideFanIn)->RangeMultiplier(10)->Range(10, 100000);
+
+// Backward through a sum of n products, each leaf feeding two nodes
+static void BM_BackwardSharedLeaves(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<ValuePtr> leaves;
+    for (size_t i = 0; i < n; i++)
+    {
+        leaves.push_back(Value::create(0.5));
+    }
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ValuePtr out = Value::create(0.0);
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            out = out + leaves[i] * leaves[i + 1];
+        }
+        state.ResumeTiming();
+        out->backward();
+        benchmark::DoNotOptimize(leaves[0]->getGrad());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BackwardSharedLeaves)->RangeMultiplier(10)->Range(10, 10000);
@@ -0,0 +1,301 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "agrad/Trace.hpp"
+#include "Dataset.hpp"
+#include "Normalizer.hpp"
+
+struct BatchLoaderOptions
+{
+    size_t batch_size = 32;
+    bool shuffle = true;
+    uint64_t seed = 0;      // shuffle seed, combined with the epoch number
+    bool drop_last = false; // skip a final batch smaller than batch_size
+    size_t workers = 1;     // background threads; 0 prepares batches on the calling thread
+    size_t prefetch = 2;    // batches prepared ahead of the one being trained on
+    const Normalizer *normalizer = nullptr; // applied by the workers as rows are copied; must outlive the loader
+};
+
+// One mini-batch in the form the MLP takes it
+struct MiniBatch
+{
+    std::vector<std::vector<double>> x;
+    std::vector<double> y;
+    size_t index = 0; // position in the epoch
+
+    size_t size() const { return y.size(); }
+};
+
+// Mini-batches over a dataset in a new seeded order every epoch. Worker threads copy rows
+// into a fixed pool of prefetch + 1 batch slots while the caller trains on the previous one,
+// so batching overlaps with forward and backward. Slots are recycled, so after the first
+// epoch no batch allocates. Batches come out in epoch order whatever the number of workers,
+// which makes a run reproducible from its seed.
+//
+// The batch returned by next() or the iterator stays valid until the following call.
+class BatchLoader
+{
+private:
+    Dataset dataset;
+    BatchLoaderOptions options;
+    std::vector<size_t> order;
+    size_t epoch = 0;
+
+    std::vector<std::unique_ptr<MiniBatch>> slots;
+    std::vector<MiniBatch *> free_slots;
+    std::vector<MiniBatch *> ready;
+    MiniBatch *held = nullptr;
+
+    // Guarded by mutex
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable batch_ready;
+    std::condition_variable workers_idle;
+    size_t total = 0;      // batches in the current epoch
+    size_t claimed = 0;    // batches handed to a worker
+    size_t consumed = 0;   // batches returned by next()
+    size_t busy = 0;       // workers filling a slot
+    uint64_t generation = 0;
+    bool in_epoch = false;
+    bool stopping = false;
+
+    std::vector<std::thread> threads;
+
+    void fill(MiniBatch &batch, size_t b) const
+    {
+        agrad::trace::Scope span("prepare_batch", "data", static_cast<int64_t>(b));
+        const size_t begin = b * options.batch_size;
+        const size_t end = std::min(begin + options.batch_size, dataset.size());
+        const size_t dim = dataset.feature_dim();
+
+        batch.x.resize(end - begin);
+        batch.y.resize(end - begin);
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *row = dataset.row(order[i]);
+            batch.x[i - begin].assign(row, row + dim);
+            if (options.normalizer)
+            {
+                options.normalizer->apply(batch.x[i - begin].data());
+            }
+            batch.y[i - begin] = dataset.label(order[i]);
+        }
+        batch.index = b;
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            work_available.wait(lock, [this]()
+                                { return stopping || (claimed < total && !free_slots.empty()); });
+            if (stopping)
+            {
+                return;
+            }
+
+            // Taking the slot before the batch number means a claimed batch always has
+            // somewhere to go, so the caller never waits on a batch that cannot be filled
+            MiniBatch *slot = free_slots.back();
+            free_slots.pop_back();
+            const size_t b = claimed++;
+            const uint64_t claimed_in = generation;
+            busy++;
+
+            lock.unlock();
+            fill(*slot, b);
+            lock.lock();
+
+            busy--;
+            if (claimed_in == generation)
+            {
+                ready.push_back(slot);
+                batch_ready.notify_all();
+            }
+            else
+            {
+                free_slots.push_back(slot);
+            }
+            workers_idle.notify_all();
+        }
+    }
+
+public:
+    BatchLoader(Dataset dataset, BatchLoaderOptions options = {})
+        : dataset(std::move(dataset)), options(options)
+    {
+        if (options.batch_size == 0)
+        {
+            throw std::invalid_argument("Batch size must be positive");
+        }
+        if (options.normalizer && options.normalizer->feature_dim() != this->dataset.feature_dim())
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+        order.resize(this->dataset.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        const size_t slot_count = options.workers == 0 ? 1 : options.prefetch + 1;
+        for (size_t i = 0; i < slot_count; i++)
+        {
+            slots.push_back(std::make_unique<MiniBatch>());
+            free_slots.push_back(slots.back().get());
+        }
+        for (size_t i = 0; i < options.workers; i++)
+        {
+            threads.emplace_back(&BatchLoader::work, this);
+        }
+    }
+
+    ~BatchLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    BatchLoader(const BatchLoader &) = delete;
+    BatchLoader &operator=(const BatchLoader &) = delete;
+
+    size_t batches_per_epoch() const
+    {
+        const size_t n = dataset.size();
+        return options.drop_last ? n / options.batch_size : (n + options.batch_size - 1) / options.batch_size;
+    }
+
+    size_t getEpoch() const { return epoch; }
+    const Dataset &getDataset() const { return dataset; }
+
+    // Shuffles for the next epoch and starts preparing its batches. An epoch in progress is
+    // abandoned.
+    void start_epoch()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (in_epoch)
+        {
+            epoch++;
+        }
+
+        // Batches of the old epoch are dropped as their workers finish
+        generation++;
+        total = 0;
+        workers_idle.wait(lock, [this]()
+                          { return busy == 0; });
+        for (MiniBatch *slot : ready)
+        {
+            free_slots.push_back(slot);
+        }
+        ready.clear();
+        if (held)
+        {
+            free_slots.push_back(held);
+            held = nullptr;
+        }
+
+        if (options.shuffle)
+        {
+            std::mt19937_64 rng(options.seed + epoch);
+            std::shuffle(order.begin(), order.end(), rng);
+        }
+        claimed = 0;
+        consumed = 0;
+        total = batches_per_epoch();
+        in_epoch = true;
+        work_available.notify_all();
+    }
+
+    // Next batch of the current epoch, or nullptr once it is over; starts a new epoch when
+    // called after the end of the previous one
+    const MiniBatch *next()
+    {
+        if (!in_epoch)
+        {
+            start_epoch();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (held)
+        {
+            free_slots.push_back(held);
+            held = nullptr;
+            work_available.notify_one();
+        }
+        if (consumed == total)
+        {
+            in_epoch = false;
+            epoch++;
+            return nullptr;
+        }
+
+        if (threads.empty())
+        {
+            held = free_slots.back();
+            free_slots.pop_back();
+            fill(*held, consumed++);
+            return held;
+        }
+
+        agrad::trace::Scope span("wait_batch", "data");
+        auto it = ready.end();
+        batch_ready.wait(lock, [&]()
+                         {
+                             it = std::find_if(ready.begin(), ready.end(), [this](const MiniBatch *s)
+                                               { return s->index == consumed; });
+                             return it != ready.end(); });
+        held = *it;
+        ready.erase(it);
+        consumed++;
+        return held;
+    }
+
+    class iterator
+    {
+    private:
+        BatchLoader *loader;
+        const MiniBatch *current;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = MiniBatch;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const MiniBatch *;
+        using reference = const MiniBatch &;
+
+        explicit iterator(BatchLoader *loader) : loader(loader), current(loader ? loader->next() : nullptr) {}
+
+        reference operator*() const { return *current; }
+        pointer operator->() const { return current; }
+
+        iterator &operator++()
+        {
+            current = loader->next();
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const { return current == other.current; }
+        bool operator!=(const iterator &other) const { return current != other.current; }
+    };
+
+    // One epoch; a new begin() reshuffles and starts over
+    iterator begin()
+    {
+        start_epoch();
+        return iterator(this);
+    }
+    iterator end() { return iterator(nullptr); }
+};
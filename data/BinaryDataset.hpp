@@ -0,0 +1,512 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "agrad/Trace.hpp"
+#include "ByteOrder.hpp"
+#include "DatasetStream.hpp"
+#include "MappedFile.hpp"
+
+// Binary dataset file that loads without parsing. All fields are little-endian:
+//
+//   offset  0  char[8]  magic "AGRADSET"
+//           8  u32      format version
+//          12  u32      dtype (0 = f64, 1 = f32)
+//          16  u64      rows
+//          24  u32      features per row
+//          28  u32      label type (LabelType)
+//          32  u64      feature block offset (multiple of 64)
+//          40  u64      label block offset (multiple of 64)
+//          48  u64      info block offset
+//          56  u64      info block size in bytes
+//          64  u32      flags (bit 0 checksum present)
+//          68  u32      reserved
+//          72  u64      checksum of the feature block followed by the label block
+//
+// The feature block is the rows x features matrix, row-major, and the label block holds one
+// label per row. The info block lists the feature names and then the class names, each list
+// as a u32 count followed by u32 length-prefixed strings. An f64 file is exactly the layout
+// of Dataset, so it is used in place from a mapping.
+class BinaryDataset
+{
+public:
+    static constexpr uint32_t version = 1;
+    static constexpr size_t block_alignment = 64;
+
+    enum class DType : uint32_t
+    {
+        F64 = 0,
+        F32 = 1,
+    };
+
+private:
+    BinaryDataset() = delete;
+
+    static constexpr char magic[8] = {'A', 'G', 'R', 'A', 'D', 'S', 'E', 'T'};
+    static constexpr size_t header_size = 80;
+    static constexpr uint32_t flag_checksum = 1;
+
+    struct Header
+    {
+        DType dtype;
+        uint64_t rows;
+        uint32_t features;
+        LabelType label_type;
+        uint64_t feature_offset;
+        uint64_t label_offset;
+        uint64_t info_offset;
+        uint64_t info_size;
+        uint32_t flags;
+        uint64_t checksum;
+    };
+
+    static size_t dtype_size(DType dtype)
+    {
+        return dtype == DType::F64 ? sizeof(double) : sizeof(float);
+    }
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + block_alignment - 1) / block_alignment * block_alignment;
+    }
+
+    // FNV-1a over 8-byte words with an extra fold of the high half, so it runs at memory
+    // speed; only meant to catch truncated or corrupted files
+    class Checksum
+    {
+    private:
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        uint64_t length = 0;
+        unsigned char pending[8];
+        size_t pending_size = 0;
+
+        void mix(uint64_t word)
+        {
+            hash = (hash ^ word) * 0x100000001b3ULL;
+            hash ^= hash >> 32;
+        }
+
+    public:
+        void update(const char *p, size_t n)
+        {
+            length += n;
+            while (n > 0 && pending_size > 0)
+            {
+                pending[pending_size++] = static_cast<unsigned char>(*p++);
+                n--;
+                if (pending_size == 8)
+                {
+                    mix(byte_order::read_le<uint64_t>(reinterpret_cast<const char *>(pending)));
+                    pending_size = 0;
+                }
+            }
+            for (; n >= 8; p += 8, n -= 8)
+            {
+                mix(byte_order::read_le<uint64_t>(p));
+            }
+            std::memcpy(pending, p, n);
+            pending_size = n;
+        }
+
+        uint64_t value() const
+        {
+            Checksum last = *this;
+            std::memset(last.pending + pending_size, 0, 8 - pending_size);
+            last.mix(byte_order::read_le<uint64_t>(reinterpret_cast<const char *>(last.pending)));
+            last.mix(length);
+            return last.hash;
+        }
+    };
+
+    static void write_string(std::ostream &out, const std::string &s)
+    {
+        byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(s.size()));
+        out.write(s.data(), s.size());
+    }
+
+    static Header parse_header(const char *data, size_t size, const std::string &filename)
+    {
+        auto invalid = [&](const std::string &reason)
+        {
+            return std::runtime_error("Invalid dataset " + filename + ": " + reason);
+        };
+
+        if (size < header_size || std::memcmp(data, magic, sizeof(magic)) != 0)
+        {
+            throw invalid("bad magic");
+        }
+        if (byte_order::read_le<uint32_t>(data + 8) != version)
+        {
+            throw invalid("unsupported version " + std::to_string(byte_order::read_le<uint32_t>(data + 8)));
+        }
+
+        Header h;
+        uint32_t dtype = byte_order::read_le<uint32_t>(data + 12);
+        uint32_t label_type = byte_order::read_le<uint32_t>(data + 28);
+        if (dtype > static_cast<uint32_t>(DType::F32))
+        {
+            throw invalid("unknown dtype");
+        }
+        if (label_type > static_cast<uint32_t>(LabelType::Multiclass))
+        {
+            throw invalid("unknown label type");
+        }
+        h.dtype = static_cast<DType>(dtype);
+        h.label_type = static_cast<LabelType>(label_type);
+        h.rows = byte_order::read_le<uint64_t>(data + 16);
+        h.features = byte_order::read_le<uint32_t>(data + 24);
+        h.feature_offset = byte_order::read_le<uint64_t>(data + 32);
+        h.label_offset = byte_order::read_le<uint64_t>(data + 40);
+        h.info_offset = byte_order::read_le<uint64_t>(data + 48);
+        h.info_size = byte_order::read_le<uint64_t>(data + 56);
+        h.flags = byte_order::read_le<uint32_t>(data + 64);
+        h.checksum = byte_order::read_le<uint64_t>(data + 72);
+
+        const uint64_t element = dtype_size(h.dtype);
+        if (h.rows > size / element || (h.features > 0 && h.rows * h.features > size / element))
+        {
+            throw invalid("blocks do not match the header");
+        }
+        if (h.feature_offset % block_alignment != 0 || h.label_offset % block_alignment != 0 ||
+            h.feature_offset < header_size ||
+            h.label_offset < h.feature_offset + h.rows * h.features * element ||
+            h.info_offset < h.label_offset + h.rows * element ||
+            h.info_size > size || h.info_offset > size - h.info_size)
+        {
+            throw invalid("blocks do not match the header");
+        }
+        return h;
+    }
+
+    static DatasetInfo parse_info(const char *p, const char *end, LabelType label_type, uint32_t features, const std::string &filename)
+    {
+        auto read_u32 = [&]()
+        {
+            if (end - p < 4)
+            {
+                throw std::runtime_error("Invalid dataset " + filename + ": truncated info block");
+            }
+            uint32_t value = byte_order::read_le<uint32_t>(p);
+            p += 4;
+            return value;
+        };
+        auto read_strings = [&](std::vector<std::string> &out)
+        {
+            for (uint32_t count = read_u32(); count > 0; count--)
+            {
+                uint32_t length = read_u32();
+                if (length > static_cast<size_t>(end - p))
+                {
+                    throw std::runtime_error("Invalid dataset " + filename + ": truncated info block");
+                }
+                out.emplace_back(p, length);
+                p += length;
+            }
+        };
+
+        DatasetInfo info;
+        info.label_type = label_type;
+        read_strings(info.feature_names);
+        read_strings(info.classes);
+        if (info.feature_names.size() != features)
+        {
+            throw std::runtime_error("Invalid dataset " + filename + ": feature names do not match the header");
+        }
+        return info;
+    }
+
+    template <typename Stored>
+    static void copy_block(const char *p, double *out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = static_cast<double>(byte_order::read_le<Stored>(p + i * sizeof(Stored)));
+        }
+    }
+
+public:
+    // Streams rows into a new file with memory bounded by one append: features go straight
+    // to their block, labels to a side file that is copied after them once the row count is
+    // known, and the header is written last
+    class Writer
+    {
+    private:
+        std::string filename;
+        std::string label_filename;
+        std::ofstream out;
+        std::fstream label_spill;
+        DType dtype;
+        bool with_checksum;
+        Checksum checksum;
+        std::vector<char> scratch;
+        uint32_t features;
+        uint64_t rows = 0;
+        bool finished = false;
+
+        // Converts values to the file dtype and byte order; returns a pointer to count values
+        const char *encode(const double *values, size_t count)
+        {
+            if (dtype == DType::F64 && byte_order::host_little_endian())
+            {
+                return reinterpret_cast<const char *>(values);
+            }
+            scratch.resize(count * dtype_size(dtype));
+            for (size_t i = 0; i < count; i++)
+            {
+                if (dtype == DType::F64)
+                {
+                    double v = byte_order::host_little_endian() ? values[i] : byte_order::byteswap(values[i]);
+                    std::memcpy(scratch.data() + i * sizeof(double), &v, sizeof(double));
+                }
+                else
+                {
+                    float f = static_cast<float>(values[i]);
+                    f = byte_order::host_little_endian() ? f : byte_order::byteswap(f);
+                    std::memcpy(scratch.data() + i * sizeof(float), &f, sizeof(float));
+                }
+            }
+            return scratch.data();
+        }
+
+        void write_features(const double *values, size_t count)
+        {
+            const char *bytes = encode(values, count);
+            const size_t size = count * dtype_size(dtype);
+            if (with_checksum)
+            {
+                checksum.update(bytes, size);
+            }
+            out.write(bytes, size);
+        }
+
+        void pad()
+        {
+            static const char zeros[block_alignment] = {};
+            const uint64_t position = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, align(position) - position);
+        }
+
+        // Appends the spilled labels to the file
+        void copy_labels()
+        {
+            label_spill.flush();
+            if (!label_spill)
+            {
+                throw std::runtime_error("Failed writing dataset: " + filename);
+            }
+            label_spill.seekg(0);
+            std::vector<char> chunk(1 << 20);
+            while (label_spill.read(chunk.data(), chunk.size()) || label_spill.gcount() > 0)
+            {
+                const size_t n = static_cast<size_t>(label_spill.gcount());
+                if (with_checksum)
+                {
+                    checksum.update(chunk.data(), n);
+                }
+                out.write(chunk.data(), n);
+            }
+            label_spill.clear();
+        }
+
+    public:
+        Writer(const std::string &filename, size_t features, DType dtype = DType::F64, bool with_checksum = true)
+            : filename(filename), label_filename(filename + ".labels"), out(filename, std::ios::binary | std::ios::trunc),
+              label_spill(label_filename, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc),
+              dtype(dtype), with_checksum(with_checksum), features(static_cast<uint32_t>(features))
+        {
+            if (!out.is_open() || !label_spill.is_open())
+            {
+                throw std::runtime_error("Unable to open file: " + filename);
+            }
+            // Placeholder header, rewritten by finish()
+            const std::vector<char> header(align(header_size), '\0');
+            out.write(header.data(), header.size());
+        }
+
+        ~Writer()
+        {
+            label_spill.close();
+            std::remove(label_filename.c_str());
+        }
+
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        // n rows of features, stride doubles apart, and their labels
+        void append(const double *x, const double *y, size_t n, size_t stride)
+        {
+            if (stride == features)
+            {
+                write_features(x, n * features);
+            }
+            else
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    write_features(x + i * stride, features);
+                }
+            }
+            label_spill.write(encode(y, n), n * dtype_size(dtype));
+            rows += n;
+        }
+
+        // Writes the labels, the info block and the header; the file is incomplete until then
+        void finish(const DatasetInfo &info)
+        {
+            if (finished)
+            {
+                throw std::logic_error("Dataset writer already finished");
+            }
+            finished = true;
+
+            const uint64_t element = dtype_size(dtype);
+            const uint64_t feature_offset = align(header_size);
+            pad();
+            const uint64_t label_offset = static_cast<uint64_t>(out.tellp());
+            copy_labels();
+
+            const uint64_t info_offset = label_offset + rows * element;
+            for (const auto *names : {&info.feature_names, &info.classes})
+            {
+                byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(names->size()));
+                for (const auto &name : *names)
+                {
+                    write_string(out, name);
+                }
+            }
+            const uint64_t info_size = static_cast<uint64_t>(out.tellp()) - info_offset;
+
+            out.seekp(0);
+            out.write(magic, sizeof(magic));
+            byte_order::write_le<uint32_t>(out, version);
+            byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(dtype));
+            byte_order::write_le<uint64_t>(out, rows);
+            byte_order::write_le<uint32_t>(out, features);
+            byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(info.label_type));
+            byte_order::write_le<uint64_t>(out, feature_offset);
+            byte_order::write_le<uint64_t>(out, label_offset);
+            byte_order::write_le<uint64_t>(out, info_offset);
+            byte_order::write_le<uint64_t>(out, info_size);
+            byte_order::write_le<uint32_t>(out, with_checksum ? flag_checksum : 0);
+            byte_order::write_le<uint32_t>(out, 0);
+            byte_order::write_le<uint64_t>(out, with_checksum ? checksum.value() : 0);
+
+            out.flush();
+            if (!out)
+            {
+                throw std::runtime_error("Failed writing dataset: " + filename);
+            }
+        }
+
+        uint64_t getRows() const { return rows; }
+    };
+
+    static void save(const Dataset &dataset, const std::string &filename, DType dtype = DType::F64, bool with_checksum = true)
+    {
+        agrad::trace::Scope span("save_binary", "data");
+        Writer writer(filename, dataset.feature_dim(), dtype, with_checksum);
+        if (dataset.is_contiguous())
+        {
+            writer.append(dataset.data(), dataset.label_data(), dataset.size(), dataset.getStride());
+        }
+        else
+        {
+            for (size_t i = 0; i < dataset.size(); i++)
+            {
+                const double label = dataset.label(i);
+                writer.append(dataset.row(i), &label, 1, dataset.feature_dim());
+            }
+        }
+        writer.finish(dataset.getInfo());
+    }
+
+    // Converts a CSV file read with the given schema, streaming it so the CSV never has to fit
+    // in memory; returns the number of rows written
+    static size_t convert_csv(const std::string &csv_filename, const std::string &filename, const DatasetSchema &schema = {},
+                              DType dtype = DType::F64, bool with_checksum = true)
+    {
+        agrad::trace::Scope span("convert_csv", "data");
+        StreamOptions options;
+        options.batch_size = 4096;
+        DatasetStream stream(csv_filename, schema, options);
+        Writer writer(filename, stream.feature_dim(), dtype, with_checksum);
+
+        size_t rows = 0;
+        for (const Dataset &batch : stream)
+        {
+            writer.append(batch.data(), batch.label_data(), batch.size(), batch.getStride());
+            rows += batch.size();
+        }
+        if (rows == 0)
+        {
+            throw std::runtime_error("No data found in file");
+        }
+        writer.finish(stream.getInfo());
+        return rows;
+    }
+
+    // Maps the file and returns a dataset on top of it. f64 data is used in place, so loading
+    // costs one mmap and the pages are read on first use; f32 data is converted into owned
+    // memory. The mapping is copy-on-write: the dataset can be modified without touching the
+    // file. verify_checksum reads the whole file up front.
+    static Dataset load(const std::string &filename, bool verify_checksum = false)
+    {
+        agrad::trace::Scope span("load_binary", "data");
+        auto file = std::make_shared<const MappedFile>(filename, true);
+        const char *data = file->data();
+        Header h = parse_header(data, file->size(), filename);
+        DatasetInfo info = parse_info(data + h.info_offset, data + h.info_offset + h.info_size, h.label_type, h.features, filename);
+
+        const size_t element = dtype_size(h.dtype);
+        const size_t feature_count = h.rows * h.features;
+        if (verify_checksum && (h.flags & flag_checksum))
+        {
+            Checksum checksum;
+            checksum.update(data + h.feature_offset, feature_count * element);
+            checksum.update(data + h.label_offset, h.rows * element);
+            if (checksum.value() != h.checksum)
+            {
+                throw std::runtime_error("Invalid dataset " + filename + ": checksum mismatch");
+            }
+        }
+
+        if (h.dtype == DType::F64 && byte_order::host_little_endian())
+        {
+            double *x = reinterpret_cast<double *>(file->mutable_data() + h.feature_offset);
+            double *y = reinterpret_cast<double *>(file->mutable_data() + h.label_offset);
+            Dataset dataset(x, y, h.rows, h.features, std::move(file));
+            dataset.setInfo(std::move(info));
+            return dataset;
+        }
+
+        Dataset dataset(h.rows, h.features);
+        double *x = h.rows ? dataset.row(0) : nullptr;
+        double *y = h.rows ? &dataset.label(0) : nullptr;
+        if (h.dtype == DType::F64)
+        {
+            copy_block<double>(data + h.feature_offset, x, feature_count);
+            copy_block<double>(data + h.label_offset, y, h.rows);
+        }
+        else
+        {
+            copy_block<float>(data + h.feature_offset, x, feature_count);
+            copy_block<float>(data + h.label_offset, y, h.rows);
+        }
+        dataset.setInfo(std::move(info));
+        return dataset;
+    }
+
+    // Whether the file starts with the binary dataset magic
+    static bool is_binary(const std::string &filename)
+    {
+        char head[sizeof(magic)] = {};
+        std::ifstream in(filename, std::ios::binary);
+        in.read(head, sizeof(head));
+        return in.gcount() == sizeof(head) && std::memcmp(head, magic, sizeof(magic)) == 0;
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstring>
+#include <ostream>
+#include <utility>
+
+// Little-endian encoding for the binary file formats (checkpoints, datasets). On little-endian
+// hosts these are plain copies.
+namespace byte_order
+{
+    constexpr bool host_little_endian()
+    {
+        return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    }
+
+    template <typename U>
+    U byteswap(U value)
+    {
+        unsigned char bytes[sizeof(U)];
+        std::memcpy(bytes, &value, sizeof(U));
+        for (size_t i = 0; i < sizeof(U) / 2; i++)
+        {
+            std::swap(bytes[i], bytes[sizeof(U) - 1 - i]);
+        }
+        std::memcpy(&value, bytes, sizeof(U));
+        return value;
+    }
+
+    template <typename U>
+    void write_le(std::ostream &out, U value)
+    {
+        if (!host_little_endian())
+        {
+            value = byteswap(value);
+        }
+        out.write(reinterpret_cast<const char *>(&value), sizeof(U));
+    }
+
+    template <typename U>
+    U read_le(const char *p)
+    {
+        U value;
+        std::memcpy(&value, p, sizeof(U));
+        return host_little_endian() ? value : byteswap(value);
+    }
+}
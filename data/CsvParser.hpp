@@ -0,0 +1,111 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+// Allocation-free CSV scanning over an in-memory buffer (typically a MappedFile). Lines and
+// fields are string_views into the buffer, delimiters are found with memchr and numbers are
+// parsed with std::from_chars, which ignores the locale and reports errors without throwing.
+class CsvParser
+{
+private:
+    const char *cursor;
+    const char *end;
+    size_t line_number = 0;
+
+public:
+    CsvParser(const char *begin, const char *end) : cursor(begin), end(end) {}
+
+    // Next line without its '\n' or "\r\n"; false at the end of the buffer. A final line
+    // without a trailing newline is still returned.
+    bool next_line(std::string_view &line)
+    {
+        if (cursor >= end)
+        {
+            return false;
+        }
+
+        const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+        const char *line_end = newline ? newline : end;
+        line = std::string_view(cursor, line_end - cursor);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        cursor = newline ? newline + 1 : end;
+        line_number++;
+        return true;
+    }
+
+    // 1-based number of the line last returned by next_line()
+    size_t getLineNumber() const { return line_number; }
+    const char *position() const { return cursor; }
+
+    // Lines in [begin, end), counting a final line without a trailing newline
+    static size_t count_lines(const char *begin, const char *end)
+    {
+        size_t lines = 0;
+        const char *p = begin;
+        while (p < end)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            lines++;
+            if (!newline)
+            {
+                break;
+            }
+            p = newline + 1;
+        }
+        return lines;
+    }
+
+    // Pops the first field off line. Returns false once nothing is left, so "a," has one field
+    // and "a,,b" has an empty second field.
+    static bool next_field(std::string_view &line, std::string_view &field, char delimiter = ',')
+    {
+        if (line.empty())
+        {
+            return false;
+        }
+
+        size_t pos = line.find(delimiter);
+        if (pos == std::string_view::npos)
+        {
+            field = line;
+            line = std::string_view();
+        }
+        else
+        {
+            field = line.substr(0, pos);
+            line.remove_prefix(pos + 1);
+        }
+        return true;
+    }
+
+    // Whole-field number parse; surrounding blanks and a leading '+' are accepted, anything
+    // else after the number is an error
+    static bool parse_double(std::string_view field, double &out)
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t'))
+        {
+            field.remove_prefix(1);
+        }
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t'))
+        {
+            field.remove_suffix(1);
+        }
+        if (field.size() > 1 && field.front() == '+' && field[1] != '-')
+        {
+            field.remove_prefix(1);
+        }
+        if (field.empty())
+        {
+            return false;
+        }
+
+        auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+        return ec == std::errc() && ptr == field.data() + field.size();
+    }
+};
@@ -1,16 +1,28 @@
 #pragma once
-#include <fstream>
-#include <sstream>
+#include <iostream>
+#include <string_view>
+#include <tuple>
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <filesystem>
 #include <algorithm>
+#include <cstring>
+#include <exception>
+#include "agrad/Parallel.hpp"
+#include "agrad/Trace.hpp"
+#include "CsvParser.hpp"
+#include "Dataset.hpp"
+#include "MappedFile.hpp"
+#include "Normalizer.hpp"
 
-struct Dataset
+// Which CSV columns to load. By default every column except the label is a feature.
+struct DatasetSchema
 {
-    std::vector<std::vector<double>> X;
-    std::vector<double> y;
+    std::vector<std::string> features; // names in the order they are stored; empty for all
+    std::string label = "label";
+    LabelType label_type = LabelType::Binary;
+    char delimiter = ',';
 };
 
 struct sample
@@ -21,14 +33,14 @@ struct sample
 struct Batch
 {
     std::vector<sample> samples;
-    static constexpr size_t feature_dim = 2;
+    size_t feature_dim = 0;
 };
 
 class DataLoader
 {
 private:
     DataLoader() = delete;
-    static std::ifstream open_file(const std::string &filename)
+    static void check_file(const std::string &filename)
     {
         // Check if file exists
         if (!std::filesystem::exists(filename))
@@ -41,141 +53,370 @@ private:
         {
             throw std::runtime_error("File is empty: " + filename);
         }
+    }
+
+    static constexpr int skip_column = -1;
+    static constexpr int label_column = -2;
 
-        std::ifstream file(filename);
-        if (!file.is_open())
+    static std::string_view trim_header(std::string_view name)
+    {
+        while (!name.empty() && (name.front() == ' ' || name.front() == '\t'))
         {
-            throw std::runtime_error("Unable to open file: " + filename);
+            name.remove_prefix(1);
         }
-
-        return file;
+        while (!name.empty() && (name.back() == ' ' || name.back() == '\t'))
+        {
+            name.remove_suffix(1);
+        }
+        if (name.size() >= 2 && name.front() == '"' && name.back() == '"')
+        {
+            name = name.substr(1, name.size() - 2);
+        }
+        return name;
     }
 
-public:
-    static Dataset load_dataset(const std::string &filename)
+    // Maps every file column to a feature slot, the label or skip_column, and fills in the
+    // feature names of info
+    static std::vector<int> plan_columns(std::string_view header, const DatasetSchema &schema, DatasetInfo &info)
     {
-        std::ifstream file = open_file(filename);
-        std::string line;
-        Dataset dataset;
-        size_t line_number = 0;
+        std::vector<std::string> columns;
+        std::string_view field;
+        while (CsvParser::next_field(header, field, schema.delimiter))
+        {
+            std::string name(trim_header(field));
+            if (std::find(columns.begin(), columns.end(), name) != columns.end())
+            {
+                throw std::runtime_error("Invalid file format: duplicate column '" + name + "'");
+            }
+            columns.push_back(std::move(name));
+        }
 
-        try
+        auto column_of = [&columns](const std::string &name)
         {
-            // Skip header
-            std::getline(file, line);
+            auto it = std::find(columns.begin(), columns.end(), name);
+            if (it == columns.end())
+            {
+                throw std::runtime_error("Invalid file format: no column named '" + name + "'");
+            }
+            return static_cast<size_t>(it - columns.begin());
+        };
+
+        std::vector<int> plan(columns.size(), skip_column);
+        plan[column_of(schema.label)] = label_column;
 
-            // Read and validate header
-            if (line != "x1,x2,label")
+        if (schema.features.empty())
+        {
+            for (size_t c = 0; c < columns.size(); c++)
             {
-                throw std::runtime_error("Invalid file format: Expected header 'x1,x2,label'");
+                if (plan[c] != label_column)
+                {
+                    plan[c] = static_cast<int>(info.feature_names.size());
+                    info.feature_names.push_back(columns[c]);
+                }
             }
+        }
+        else
+        {
+            for (const auto &name : schema.features)
+            {
+                size_t c = column_of(name);
+                if (plan[c] != skip_column)
+                {
+                    throw std::invalid_argument("Column '" + name + "' is selected twice or is also the label");
+                }
+                plan[c] = static_cast<int>(info.feature_names.size());
+                info.feature_names.push_back(name);
+            }
+        }
 
-            // Read data
-            while (std::getline(file, line))
+        // Columns after the last selected one are never looked at
+        while (plan.back() == skip_column)
+        {
+            plan.pop_back();
+        }
+        return plan;
+    }
+
+    static bool parse_label(std::string_view value, DatasetInfo &info, double &label)
+    {
+        switch (info.label_type)
+        {
+        case LabelType::Binary:
+            return CsvParser::parse_double(value, label) && (label == -1.0 || label == 1.0);
+        case LabelType::Regression:
+            return CsvParser::parse_double(value, label);
+        default:
+        {
+            value = trim_header(value);
+            if (value.empty())
+            {
+                return false;
+            }
+            // Few classes in practice, so a linear scan beats hashing a new string per row
+            auto it = std::find(info.classes.begin(), info.classes.end(), value);
+            if (it == info.classes.end())
             {
-                line_number++;
-                std::stringstream ss(line);
-                std::string value;
-                std::vector<double> row;
+                info.classes.emplace_back(value);
+                it = info.classes.end() - 1;
+            }
+            label = static_cast<double>(it - info.classes.begin());
+            return true;
+        }
+        }
+    }
 
-                // Read x1, x2
-                for (int i = 0; i < 2; i++)
+    // Parses one data line into row and label following plan; line_number is only used in
+    // error messages
+    static void parse_row(std::string_view line, const std::vector<int> &plan, char delimiter, DatasetInfo &info,
+                          double *row, double &label, size_t line_number)
+    {
+        std::string_view value;
+        for (int slot : plan)
+        {
+            if (!CsvParser::next_field(line, value, delimiter))
+            {
+                throw std::runtime_error((slot == label_column ? "Missing label in line " : "Missing value in line ") + std::to_string(line_number));
+            }
+            if (slot == skip_column)
+            {
+                continue;
+            }
+            if (slot == label_column)
+            {
+                if (!parse_label(value, info, label))
                 {
-                    if (!std::getline(ss, value, ','))
-                    {
-                        throw std::runtime_error("Missing value in line " +
-                                                 std::to_string(line_number));
-                    }
-                    try
-                    {
-                        row.push_back(std::stod(value));
-                    }
-                    catch (const std::exception &e)
-                    {
-                        throw std::runtime_error("Invalid number format in line " +
-                                                 std::to_string(line_number) + ": " + value);
-                    }
+                    throw std::runtime_error("Invalid label format in line " + std::to_string(line_number) + ": " + std::string(value));
                 }
-                dataset.X.push_back(row);
+            }
+            else if (!CsvParser::parse_double(value, row[slot]))
+            {
+                throw std::runtime_error("Invalid number format in line " + std::to_string(line_number) + ": " + std::string(value));
+            }
+        }
+    }
+
+    friend class DatasetStream;
+
+    // Splits [begin, end) into n ranges of about equal size that start at line starts;
+    // returns the n + 1 boundaries (some ranges may be empty)
+    static std::vector<const char *> split_lines(const char *begin, const char *end, size_t n)
+    {
+        std::vector<const char *> bounds{begin};
+        for (size_t i = 1; i < n; i++)
+        {
+            const char *p = std::max(begin + (end - begin) * i / n, bounds.back());
+            const char *newline = p < end ? static_cast<const char *>(std::memchr(p, '\n', end - p)) : nullptr;
+            bounds.push_back(newline ? newline + 1 : end);
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
 
-                // Read label
-                if (!std::getline(ss, value, ','))
+    // Rewrites multiclass labels from each chunk's own class numbering to one numbering in
+    // order of first appearance in the file
+    static void merge_classes(Dataset &dataset, const std::vector<DatasetInfo> &chunk_infos, const std::vector<size_t> &first_row, DatasetInfo &info)
+    {
+        for (size_t c = 0; c < chunk_infos.size(); c++)
+        {
+            std::vector<double> to_global;
+            bool identity = true;
+            for (const auto &name : chunk_infos[c].classes)
+            {
+                auto it = std::find(info.classes.begin(), info.classes.end(), name);
+                if (it == info.classes.end())
                 {
-                    throw std::runtime_error("Missing label in line " +
-                                             std::to_string(line_number));
+                    info.classes.push_back(name);
+                    it = info.classes.end() - 1;
                 }
-                try
+                to_global.push_back(static_cast<double>(it - info.classes.begin()));
+                identity = identity && to_global.back() == to_global.size() - 1;
+            }
+            if (!identity)
+            {
+                for (size_t r = first_row[c]; r < first_row[c + 1]; r++)
                 {
-                    double label = std::stod(value);
-                    if (label != -1.0 && label != 1.0)
-                    {
-                        throw std::runtime_error("Invalid label in line " +
-                                                 std::to_string(line_number) +
-                                                 ": Expected -1 or 1, got " + value);
-                    }
-                    dataset.y.push_back(label);
+                    dataset.label(r) = to_global[static_cast<size_t>(dataset.label(r))];
                 }
-                catch (const std::exception &e)
+            }
+        }
+    }
+
+public:
+    // Below this many bytes per thread a file is not worth splitting
+    static constexpr size_t parallel_chunk_bytes = 4 << 20;
+
+    // Parses the memory-mapped file in place: numbers are read with std::from_chars and
+    // columns the schema does not select are skipped without being parsed. Large files are
+    // cut into newline-aligned ranges that are counted and then parsed concurrently, each
+    // straight into its rows of the final dataset, so the result and any error (the first
+    // one in the file) are the same as with one thread. threads = 0 picks one per core,
+    // limited by file size.
+    //
+    // Normalization rides along with parsing while each row is still in cache: stats, if
+    // given, receives the statistics of the raw features, and normalizer, if given, is
+    // applied to every row as it is stored.
+    static Dataset load_dataset(const std::string &filename, const DatasetSchema &schema = {}, size_t threads = 0,
+                                FeatureStats *stats = nullptr, const Normalizer *normalizer = nullptr)
+    {
+        agrad::trace::Scope span("load_dataset", "data");
+        check_file(filename);
+        MappedFile file(filename);
+        file.advise_sequential();
+
+        CsvParser parser(file.data(), file.data() + file.size());
+        std::string_view line;
+        if (!parser.next_line(line))
+        {
+            throw std::runtime_error("Invalid file format: missing header");
+        }
+
+        DatasetInfo info;
+        info.label_type = schema.label_type;
+        const std::vector<int> plan = plan_columns(line, schema, info);
+        const size_t features = info.feature_names.size();
+        if (normalizer && normalizer->feature_dim() != features)
+        {
+            throw std::invalid_argument("Normalizer has " + std::to_string(normalizer->feature_dim()) + " features, file has " + std::to_string(features));
+        }
+
+        const char *data_begin = parser.position();
+        const char *data_end = file.data() + file.size();
+        if (threads == 0)
+        {
+            const size_t by_size = static_cast<size_t>(data_end - data_begin) / parallel_chunk_bytes;
+            threads = std::max<size_t>(1, std::min(agrad::thread_count(0), by_size));
+        }
+        const std::vector<const char *> bounds = split_lines(data_begin, data_end, threads);
+
+        // Every line is a row (or an error), so counting first lets storage be allocated
+        // once and gives each chunk its first row and line number
+        std::vector<size_t> first_row(threads + 1, 0);
+        agrad::parallel_for(threads, [&](size_t c)
+                     { first_row[c + 1] = CsvParser::count_lines(bounds[c], bounds[c + 1]); });
+        for (size_t c = 0; c < threads; c++)
+        {
+            first_row[c + 1] += first_row[c];
+        }
+        if (first_row[threads] == 0)
+        {
+            throw std::runtime_error("No data found in file");
+        }
+        Dataset dataset(first_row[threads], features);
+
+        std::vector<DatasetInfo> chunk_infos(threads, info);
+        std::vector<FeatureStats> chunk_stats(stats ? threads : 0, FeatureStats(features));
+        std::vector<std::exception_ptr> errors(threads);
+        agrad::parallel_for(threads, [&](size_t c)
+                     {
+            agrad::trace::Scope chunk_span("parse_chunk", "data", static_cast<int64_t>(c));
+            try
+            {
+                CsvParser chunk(bounds[c], bounds[c + 1]);
+                std::string_view row_line;
+                for (size_t r = first_row[c]; chunk.next_line(row_line); r++)
                 {
-                    throw std::runtime_error("Invalid label format in line " +
-                                             std::to_string(line_number) + ": " + value);
+                    // Data line numbers start at 1 after the header
+                    double *row = dataset.row(r);
+                    parse_row(row_line, plan, schema.delimiter, chunk_infos[c], row, dataset.label(r), r + 1);
+                    if (stats)
+                    {
+                        chunk_stats[c].add(row);
+                    }
+                    if (normalizer)
+                    {
+                        normalizer->apply(row);
+                    }
                 }
             }
+            catch (...)
+            {
+                errors[c] = std::current_exception();
+            } });
 
-            // Check if dataset is empty
-            if (dataset.X.empty())
+        // A chunk stops at its first error, so the earliest chunk has the file's first error
+        for (const auto &error : errors)
+        {
+            if (error)
             {
-                throw std::runtime_error("No data found in file");
+                std::rethrow_exception(error);
             }
         }
-        catch (const std::exception &e)
+
+        if (schema.label_type == LabelType::Multiclass)
         {
-            file.close();
-            throw; // Re-throw the exception
+            merge_classes(dataset, chunk_infos, first_row, info);
         }
-
-        file.close();
+        if (stats)
+        {
+            *stats = FeatureStats(features);
+            for (const auto &part : chunk_stats)
+            {
+                stats->merge(part);
+            }
+        }
+        dataset.setInfo(std::move(info));
         return dataset;
     }
 
     static std::tuple<Dataset, Dataset> train_test_split(const Dataset &dataset, double split, size_t max_size = 0)
     {
+        agrad::trace::Scope span("train_test_split", "data");
         if (split < 0.0 || split > 1.0)
         {
             throw std::invalid_argument("split must be in the range [0, 1]");
         }
 
-        Dataset train_set, test_set;
-        double max_samples = max_size > 0 ? std::min(max_size, dataset.X.size()) : dataset.X.size();
+        // Both parts are views into the same storage
+        size_t max_samples = max_size > 0 ? std::min(max_size, dataset.size()) : dataset.size();
         size_t train_samples = static_cast<size_t>(split * max_samples);
 
-        for (size_t i = 0; i < max_samples; i++)
+        return {dataset.slice(0, train_samples), dataset.slice(train_samples, max_samples)};
+    }
+
+    // Utility function to print dataset info
+    static void print_dataset_info(const Dataset &dataset)
+    {
+        std::cout << "Dataset Information:" << std::endl;
+        std::cout << "Number of samples: " << dataset.size() << std::endl;
+        std::cout << "Number of features: " << dataset.feature_dim() << std::endl;
+
+        const std::vector<double> labels = dataset.label_vector();
+        if (dataset.getLabelType() == LabelType::Regression)
         {
-            if (i < train_samples)
+            double lo = 0.0, hi = 0.0, sum = 0.0;
+            if (!labels.empty())
             {
-                train_set.X.push_back(dataset.X[i]);
-                train_set.y.push_back(dataset.y[i]);
+                auto [min_it, max_it] = std::minmax_element(labels.begin(), labels.end());
+                lo = *min_it;
+                hi = *max_it;
             }
-            else
+            for (double label : labels)
             {
-                test_set.X.push_back(dataset.X[i]);
-                test_set.y.push_back(dataset.y[i]);
+                sum += label;
             }
+            std::cout << "Targets: min " << lo << ", max " << hi << ", mean " << (labels.empty() ? 0.0 : sum / labels.size()) << std::endl;
+            return;
         }
 
-        return {train_set, test_set};
-    }
-
-    // Utility function to print dataset info
-    static void print_dataset_info(const Dataset &dataset)
-    {
-        std::cout << "Dataset Information:" << std::endl;
-        std::cout << "Number of samples: " << dataset.X.size() << std::endl;
-        std::cout << "Number of features: " << (dataset.X.empty() ? 0 : dataset.X[0].size()) << std::endl;
+        if (dataset.getLabelType() == LabelType::Multiclass)
+        {
+            const auto &classes = dataset.getClasses();
+            std::vector<size_t> counts(classes.size());
+            for (double label : labels)
+            {
+                counts[static_cast<size_t>(label)]++;
+            }
+            std::cout << "Class distribution:" << std::endl;
+            for (size_t c = 0; c < counts.size(); c++)
+            {
+                std::cout << "  " << classes[c] << ": " << counts[c] << std::endl;
+            }
+            return;
+        }
 
         // Count classes
         int class_neg = 0, class_pos = 0;
-        for (const auto &label : dataset.y)
+        for (const auto &label : labels)
         {
             if (label == -1)
                 class_neg++;
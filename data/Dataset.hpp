@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class LabelType
+{
+    Binary,     // -1 or 1
+    Regression, // any number
+    Multiclass, // class names, stored as their index in classes
+};
+
+struct DatasetInfo
+{
+    std::vector<std::string> feature_names;
+    LabelType label_type = LabelType::Binary;
+    std::vector<std::string> classes; // Multiclass only, indexed by label
+};
+
+// Features in one row-major matrix plus a label per row. Copies, slices and selections are
+// views that share the storage, so splitting or batching a dataset never copies rows;
+// materialize() makes an independent contiguous copy. Writes through row() or label() are
+// seen by every view of the same storage, setInfo() only changes the view it is called on.
+class Dataset
+{
+private:
+    // Either owned vectors or memory kept alive by owner (e.g. a mapped file)
+    struct Storage
+    {
+        std::vector<double> features;
+        std::vector<double> labels;
+        std::shared_ptr<const void> owner;
+        double *x = nullptr;
+        double *y = nullptr;
+        size_t rows = 0;
+    };
+
+    std::shared_ptr<Storage> storage;
+    std::shared_ptr<DatasetInfo> info;
+    // Storage rows of an index view; a plain view covers storage rows first..first+count
+    std::shared_ptr<const std::vector<size_t>> indices;
+    size_t first = 0;
+    size_t count = 0;
+    size_t dim = 0;
+    size_t stride = 0;
+
+    size_t storage_row(size_t i) const { return indices ? (*indices)[first + i] : first + i; }
+
+    bool owns_all_storage() const
+    {
+        return !indices && first == 0 && (!storage || (!storage->owner && count == storage->rows));
+    }
+
+public:
+    Dataset() : info(std::make_shared<DatasetInfo>()) {}
+
+    // rows x feature_dim zero-filled dataset, to be written through row() and label()
+    Dataset(size_t rows, size_t feature_dim)
+        : storage(std::make_shared<Storage>()), info(std::make_shared<DatasetInfo>()),
+          count(rows), dim(feature_dim), stride(feature_dim)
+    {
+        storage->features.resize(rows * feature_dim);
+        storage->labels.resize(rows);
+        storage->x = storage->features.data();
+        storage->y = storage->labels.data();
+        storage->rows = rows;
+    }
+
+    // View over rows x feature_dim features and rows labels owned by owner; the caller
+    // guarantees both arrays are that large
+    Dataset(double *features, double *labels, size_t rows, size_t feature_dim, std::shared_ptr<const void> owner)
+        : storage(std::make_shared<Storage>()), info(std::make_shared<DatasetInfo>()),
+          count(rows), dim(feature_dim), stride(feature_dim)
+    {
+        storage->owner = std::move(owner);
+        storage->x = features;
+        storage->y = labels;
+        storage->rows = rows;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t feature_dim() const { return dim ? dim : info->feature_names.size(); }
+    // Doubles between consecutive rows of storage
+    size_t getStride() const { return stride; }
+
+    const double *row(size_t i) const { return storage->x + storage_row(i) * stride; }
+    double *row(size_t i) { return storage->x + storage_row(i) * stride; }
+    double label(size_t i) const { return storage->y[storage_row(i)]; }
+    double &label(size_t i) { return storage->y[storage_row(i)]; }
+
+    // Rows are evenly spaced in memory, so data() and label_data() describe the whole view
+    bool is_contiguous() const { return !indices; }
+    const double *data() const { return is_contiguous() && storage ? storage->x + first * stride : nullptr; }
+    const double *label_data() const { return is_contiguous() && storage ? storage->y + first : nullptr; }
+
+    const DatasetInfo &getInfo() const { return *info; }
+    const std::vector<std::string> &getFeatureNames() const { return info->feature_names; }
+    LabelType getLabelType() const { return info->label_type; }
+    const std::vector<std::string> &getClasses() const { return info->classes; }
+    // Gives this view its own info block; other views keep theirs
+    void setInfo(DatasetInfo new_info) { info = std::make_shared<DatasetInfo>(std::move(new_info)); }
+
+    // Rows [begin, end) of this view
+    Dataset slice(size_t begin, size_t end) const
+    {
+        if (begin > end || end > count)
+        {
+            throw std::out_of_range("Dataset slice out of range");
+        }
+        Dataset view = *this;
+        view.first = first + begin;
+        view.count = end - begin;
+        return view;
+    }
+
+    // The given rows of this view, in that order
+    Dataset select(const std::vector<size_t> &rows) const
+    {
+        auto storage = std::make_shared<std::vector<size_t>>();
+        storage->reserve(rows.size());
+        for (size_t r : rows)
+        {
+            if (r >= count)
+            {
+                throw std::out_of_range("Dataset row index out of range");
+            }
+            storage->push_back(storage_row(r));
+        }
+
+        Dataset view = *this;
+        view.indices = std::move(storage);
+        view.first = 0;
+        view.count = rows.size();
+        return view;
+    }
+
+    // Contiguous copy with its own storage and info
+    Dataset materialize() const
+    {
+        Dataset copy(count, dim);
+        *copy.info = *info;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::copy(row(i), row(i) + dim, copy.row(i));
+            copy.label(i) = label(i);
+        }
+        return copy;
+    }
+
+    // Appends a row; only allowed on a dataset that owns its storage and is not a view into
+    // other rows
+    void push_back(const std::vector<double> &x, double y)
+    {
+        if (!owns_all_storage())
+        {
+            throw std::logic_error("Cannot append to a dataset view");
+        }
+        if (!storage)
+        {
+            storage = std::make_shared<Storage>();
+            dim = stride = x.size();
+        }
+        if (x.size() != dim)
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+        storage->features.insert(storage->features.end(), x.begin(), x.end());
+        storage->labels.push_back(y);
+        storage->x = storage->features.data();
+        storage->y = storage->labels.data();
+        storage->rows++;
+        count++;
+    }
+
+    // Drops rows past the first n from this view
+    void truncate(size_t n)
+    {
+        if (n < count)
+        {
+            count = n;
+        }
+    }
+
+    std::vector<double> row_vector(size_t i) const { return std::vector<double>(row(i), row(i) + dim); }
+
+    std::vector<double> label_vector() const
+    {
+        std::vector<double> out(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = label(i);
+        }
+        return out;
+    }
+};
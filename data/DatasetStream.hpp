@@ -0,0 +1,340 @@
+#pragma once
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "agrad/Trace.hpp"
+#include "DataLoader.hpp"
+
+struct StreamOptions
+{
+    size_t batch_size = 32;
+    size_t chunk_bytes = 1 << 20; // bytes read from the file at a time
+    size_t shuffle_window = 0;    // rows held for shuffling; 0 keeps file order
+    uint64_t seed = 0;            // shuffle seed, combined with the epoch number
+    bool drop_last = false;       // skip a final batch smaller than batch_size
+    const Normalizer *normalizer = nullptr; // applied to every batch row; must outlive the stream
+};
+
+// Reads a CSV file in fixed-size chunks and yields mini-batches, so a file of any size is
+// trained on with memory bounded by chunk_bytes plus shuffle_window and batch_size rows.
+// Columns are chosen by the same DatasetSchema as DataLoader::load_dataset.
+//
+// Each pass over the file is an epoch: a range-for over the stream runs one epoch, starting
+// over from the top of the file when the previous one was read. With a shuffle window the
+// rows go through a reservoir of that many rows and leave it in random order, which mixes
+// rows within about shuffle_window of each other; the order differs every epoch.
+//
+// The first complete epoch also gathers the feature statistics of the file, so a normalizer
+// can be fitted without a separate pass.
+//
+// The batch returned by next() or the iterator is overwritten by the following one.
+class DatasetStream
+{
+private:
+    std::string filename;
+    DatasetSchema schema;
+    StreamOptions options;
+    std::ifstream file;
+    DatasetInfo info;
+    std::vector<int> plan;
+    size_t features = 0;
+
+    // Bytes [pos, filled) of buffer are read but not yet parsed
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t filled = 0;
+    bool eof = false;
+    size_t line_number = 0;
+
+    // Reservoir of shuffle_window rows, features row-major
+    std::vector<double> window_x;
+    std::vector<double> window_y;
+    size_t window_rows = 0;
+    std::mt19937_64 rng;
+
+    FeatureStats stats;
+    bool stats_complete = false;
+
+    Dataset batch;
+    size_t batch_classes = 0; // classes in the info last given to batch
+    size_t epoch = 0;
+    bool started = false;  // an epoch is in progress
+    bool at_start = false; // only the header has been read
+
+    // Next line of the file without its line ending; false at the end of the file
+    bool next_line(std::string_view &line)
+    {
+        while (true)
+        {
+            const char *begin = buffer.data() + pos;
+            const char *newline = static_cast<const char *>(std::memchr(begin, '\n', filled - pos));
+            if (newline || (eof && pos < filled))
+            {
+                const char *line_end = newline ? newline : buffer.data() + filled;
+                line = std::string_view(begin, line_end - begin);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.remove_suffix(1);
+                }
+                pos = newline ? newline - buffer.data() + 1 : filled;
+                line_number++;
+                return true;
+            }
+            if (eof)
+            {
+                return false;
+            }
+            fill();
+        }
+    }
+
+    // Moves the unparsed tail to the front and reads the next chunk after it. A line longer
+    // than the buffer grows it.
+    void fill()
+    {
+        agrad::trace::Scope span("stream_read", "data");
+        std::memmove(buffer.data(), buffer.data() + pos, filled - pos);
+        filled -= pos;
+        pos = 0;
+        if (filled == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        file.read(buffer.data() + filled, buffer.size() - filled);
+        filled += static_cast<size_t>(file.gcount());
+        if (file.eof())
+        {
+            eof = true;
+        }
+        else if (!file)
+        {
+            throw std::runtime_error("Failed reading file: " + filename);
+        }
+    }
+
+    void rewind()
+    {
+        file.clear();
+        file.seekg(0);
+        pos = filled = 0;
+        eof = false;
+        line_number = 0;
+
+        std::string_view header;
+        if (!next_line(header))
+        {
+            throw std::runtime_error("Invalid file format: missing header");
+        }
+        at_start = true;
+    }
+
+    // Parses the next data line into x and y; false at the end of the file
+    bool read_row(double *x, double &y)
+    {
+        std::string_view line;
+        if (!next_line(line))
+        {
+            return false;
+        }
+        at_start = false;
+        // Data line numbers start at 1 after the header
+        DataLoader::parse_row(line, plan, schema.delimiter, info, x, y, line_number - 1);
+        if (!stats_complete)
+        {
+            stats.add(x);
+        }
+        return true;
+    }
+
+    // Fills the next batch row, going through the shuffle window when there is one
+    bool next_row(double *x, double &y)
+    {
+        const size_t window = options.shuffle_window;
+        if (window == 0)
+        {
+            return read_row(x, y);
+        }
+
+        while (window_rows < window && read_row(window_x.data() + window_rows * features, window_y[window_rows]))
+        {
+            window_rows++;
+        }
+        if (window_rows == 0)
+        {
+            return false;
+        }
+
+        // Hand out a random row and fill its slot from the file, or from the end of the
+        // window once the file is drained
+        size_t pick = std::uniform_int_distribution<size_t>(0, window_rows - 1)(rng);
+        double *slot = window_x.data() + pick * features;
+        std::copy(slot, slot + features, x);
+        y = window_y[pick];
+        if (!read_row(slot, window_y[pick]))
+        {
+            window_rows--;
+            std::copy(window_x.data() + window_rows * features, window_x.data() + (window_rows + 1) * features, slot);
+            window_y[pick] = window_y[window_rows];
+        }
+        return true;
+    }
+
+public:
+    DatasetStream(const std::string &filename, const DatasetSchema &schema = {}, const StreamOptions &options = {})
+        : filename(filename), schema(schema), options(options), file(filename, std::ios::binary)
+    {
+        if (options.batch_size == 0 || options.chunk_bytes == 0)
+        {
+            throw std::invalid_argument("Batch size and chunk size must be positive");
+        }
+        DataLoader::check_file(filename);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+        buffer.resize(options.chunk_bytes);
+
+        std::string_view header;
+        if (!next_line(header))
+        {
+            throw std::runtime_error("Invalid file format: missing header");
+        }
+        info.label_type = schema.label_type;
+        plan = DataLoader::plan_columns(header, schema, info);
+        features = info.feature_names.size();
+        at_start = true;
+        stats = FeatureStats(features);
+        if (options.normalizer && options.normalizer->feature_dim() != features)
+        {
+            throw std::invalid_argument("Normalizer has " + std::to_string(options.normalizer->feature_dim()) + " features, file has " + std::to_string(features));
+        }
+
+        window_x.resize(options.shuffle_window * features);
+        window_y.resize(options.shuffle_window);
+    }
+
+    DatasetStream(const DatasetStream &) = delete;
+    DatasetStream &operator=(const DatasetStream &) = delete;
+
+    // Next batch of the current epoch; false once the epoch is over. Starts a new epoch when
+    // called after the end of the previous one.
+    bool next(Dataset &out)
+    {
+        agrad::trace::Scope span("stream_batch", "data");
+        if (!started)
+        {
+            start_epoch();
+        }
+
+        if (batch.size() != options.batch_size)
+        {
+            batch = Dataset(options.batch_size, features);
+            batch.setInfo(info);
+            batch_classes = info.classes.size();
+        }
+
+        size_t rows = 0;
+        while (rows < options.batch_size && next_row(batch.row(rows), batch.label(rows)))
+        {
+            if (options.normalizer)
+            {
+                options.normalizer->apply(batch.row(rows));
+            }
+            rows++;
+        }
+
+        if (rows == 0 || (options.drop_last && rows < options.batch_size))
+        {
+            // Rows dropped with the last batch were still read, so the statistics are whole
+            stats_complete = true;
+            started = false;
+            epoch++;
+            return false;
+        }
+
+        if (info.classes.size() != batch_classes)
+        {
+            batch.setInfo(info);
+            batch_classes = info.classes.size();
+        }
+        out = rows == options.batch_size ? batch : batch.slice(0, rows);
+        return true;
+    }
+
+    // Rewinds to the first row; the next batch begins a new epoch with a new shuffle order.
+    // An epoch in progress is abandoned.
+    void start_epoch()
+    {
+        if (started)
+        {
+            epoch++;
+        }
+        if (!at_start)
+        {
+            rewind();
+        }
+        if (!stats_complete)
+        {
+            stats = FeatureStats(features);
+        }
+        window_rows = 0;
+        rng.seed(options.seed + epoch);
+        started = true;
+    }
+
+    size_t getEpoch() const { return epoch; }
+    // Raw feature statistics of the file once an epoch has been completed (partial before)
+    const FeatureStats &getStats() const { return stats; }
+    bool hasStats() const { return stats_complete; }
+    size_t feature_dim() const { return features; }
+    // Column names and label type; multiclass class names grow as rows are read
+    const DatasetInfo &getInfo() const { return info; }
+
+    class iterator
+    {
+    private:
+        DatasetStream *stream;
+        Dataset current;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Dataset;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Dataset *;
+        using reference = const Dataset &;
+
+        explicit iterator(DatasetStream *stream) : stream(stream)
+        {
+            ++*this;
+        }
+        iterator() : stream(nullptr) {}
+
+        reference operator*() const { return current; }
+        pointer operator->() const { return &current; }
+
+        iterator &operator++()
+        {
+            if (stream && !stream->next(current))
+            {
+                stream = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const { return stream == other.stream; }
+        bool operator!=(const iterator &other) const { return stream != other.stream; }
+    };
+
+    // One epoch; a new begin() starts over from the top of the file
+    iterator begin()
+    {
+        start_epoch();
+        return iterator(this);
+    }
+    iterator end() { return iterator(); }
+};
@@ -0,0 +1,341 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "agrad/Parallel.hpp"
+#include "agrad/Random.hpp"
+#include "agrad/Trace.hpp"
+#include "BinaryDataset.hpp"
+#include "Dataset.hpp"
+
+// Synthetic dataset: row i is a pure function of (seed, i), drawn from Philox stream i, so
+// rows are independent and identically distributed, any prefix is a shuffled sample, and a
+// dataset is the same whatever the number of threads that generate it
+class DataGenerator
+{
+protected:
+    uint64_t seed;
+
+    // Philox blocks of a row past the ones its normal draws use
+    static constexpr uint64_t control_block = uint64_t(1) << 40;
+    // Stream for values shared by all rows (e.g. cluster centers), far from any row index
+    static constexpr uint64_t shared_stream = ~uint64_t(0);
+
+    // Two uniforms in [0, 1) for row i, from one Philox block
+    void uniforms(uint64_t i, double &u0, double &u1) const
+    {
+        Philox::Counter r = Philox::generate(seed, i, control_block);
+        u0 = Philox::to_unit(r[0], r[1]);
+        u1 = Philox::to_unit(r[2], r[3]);
+    }
+
+    static std::vector<std::string> numbered(const std::string &prefix, size_t n)
+    {
+        std::vector<std::string> names;
+        for (size_t i = 1; i <= n; i++)
+        {
+            names.push_back(prefix + std::to_string(i));
+        }
+        return names;
+    }
+
+public:
+    explicit DataGenerator(uint64_t seed) : seed(seed) {}
+    virtual ~DataGenerator() = default;
+
+    virtual size_t feature_dim() const = 0;
+    virtual DatasetInfo info() const = 0;
+    virtual void sample(uint64_t i, double *x, double &y) const = 0;
+};
+
+// Two interleaving half circles (sklearn's make_moons); labels -1 and 1
+class MoonsGenerator : public DataGenerator
+{
+private:
+    double noise;
+
+public:
+    MoonsGenerator(double noise = 0.1, uint64_t seed = 0) : DataGenerator(seed), noise(noise) {}
+
+    size_t feature_dim() const override { return 2; }
+    DatasetInfo info() const override { return {{"x1", "x2"}, LabelType::Binary, {}}; }
+
+    void sample(uint64_t i, double *x, double &y) const override
+    {
+        constexpr double pi = 3.14159265358979323846;
+        double u0, u1;
+        uniforms(i, u0, u1);
+        const bool inner = u0 < 0.5;
+        const double t = pi * u1;
+        Philox::normal(x, 2, 0.0, noise, seed, i);
+        x[0] += inner ? 1.0 - std::cos(t) : std::cos(t);
+        x[1] += inner ? 0.5 - std::sin(t) : std::sin(t);
+        y = inner ? 1.0 : -1.0;
+    }
+};
+
+// A circle inside another (sklearn's make_circles); the inner one, radius factor, is class 1
+class CirclesGenerator : public DataGenerator
+{
+private:
+    double noise;
+    double factor;
+
+public:
+    CirclesGenerator(double noise = 0.1, double factor = 0.5, uint64_t seed = 0) : DataGenerator(seed), noise(noise), factor(factor)
+    {
+        if (factor <= 0.0 || factor >= 1.0)
+        {
+            throw std::invalid_argument("factor must be in the range (0, 1)");
+        }
+    }
+
+    size_t feature_dim() const override { return 2; }
+    DatasetInfo info() const override { return {{"x1", "x2"}, LabelType::Binary, {}}; }
+
+    void sample(uint64_t i, double *x, double &y) const override
+    {
+        constexpr double two_pi = 6.283185307179586476925286766559;
+        double u0, u1;
+        uniforms(i, u0, u1);
+        const bool inner = u0 < 0.5;
+        const double t = two_pi * u1;
+        const double radius = inner ? factor : 1.0;
+        Philox::normal(x, 2, 0.0, noise, seed, i);
+        x[0] += radius * std::cos(t);
+        x[1] += radius * std::sin(t);
+        y = inner ? 1.0 : -1.0;
+    }
+};
+
+// Isotropic Gaussian clusters around centers drawn uniformly from [-box, box] (sklearn's
+// make_blobs); labels are cluster numbers 0 .. centers - 1
+class BlobsGenerator : public DataGenerator
+{
+private:
+    size_t features;
+    size_t centers;
+    double cluster_std;
+    std::vector<double> center_points; // centers x features
+
+public:
+    BlobsGenerator(size_t centers = 3, size_t features = 2, double cluster_std = 1.0, double box = 10.0, uint64_t seed = 0)
+        : DataGenerator(seed), features(features), centers(centers), cluster_std(cluster_std), center_points(centers * features)
+    {
+        if (centers == 0 || features == 0)
+        {
+            throw std::invalid_argument("Blobs need at least one center and one feature");
+        }
+        Philox::uniform(center_points.data(), center_points.size(), -box, box, seed, shared_stream);
+    }
+
+    size_t feature_dim() const override { return features; }
+    DatasetInfo info() const override { return {numbered("x", features), LabelType::Multiclass, numbered("blob", centers)}; }
+    const std::vector<double> &getCenters() const { return center_points; }
+
+    void sample(uint64_t i, double *x, double &y) const override
+    {
+        double u0, u1;
+        uniforms(i, u0, u1);
+        const size_t c = std::min(centers - 1, static_cast<size_t>(u0 * centers));
+        Philox::normal(x, features, 0.0, cluster_std, seed, i);
+        for (size_t f = 0; f < features; f++)
+        {
+            x[f] += center_points[c * features + f];
+        }
+        y = static_cast<double>(c);
+    }
+};
+
+// High-dimensional binary classification in the spirit of sklearn's make_classification:
+// the classes are unit Gaussians around opposite vertices of a hypercube with side
+// 2 * class_sep in the first informative features, the remaining features are pure noise,
+// and a flip_y fraction of labels is flipped. Labels are -1 and 1.
+class ClassificationGenerator : public DataGenerator
+{
+private:
+    size_t features;
+    size_t informative;
+    double class_sep;
+    double flip_y;
+    std::vector<double> vertex; // class 1 center in the informative features; class -1 is -vertex
+
+public:
+    ClassificationGenerator(size_t features = 20, size_t informative = 2, double class_sep = 1.0, double flip_y = 0.01, uint64_t seed = 0)
+        : DataGenerator(seed), features(features), informative(informative), class_sep(class_sep), flip_y(flip_y), vertex(informative)
+    {
+        if (informative == 0 || informative > features)
+        {
+            throw std::invalid_argument("informative must be between 1 and features");
+        }
+        Philox::uniform(vertex.data(), informative, -1.0, 1.0, seed, shared_stream);
+        for (double &v : vertex)
+        {
+            v = v < 0.0 ? -class_sep : class_sep;
+        }
+    }
+
+    size_t feature_dim() const override { return features; }
+    DatasetInfo info() const override { return {numbered("x", features), LabelType::Binary, {}}; }
+
+    void sample(uint64_t i, double *x, double &y) const override
+    {
+        double u0, u1;
+        uniforms(i, u0, u1);
+        const double label = u0 < 0.5 ? -1.0 : 1.0;
+        Philox::normal(x, features, 0.0, 1.0, seed, i);
+        for (size_t f = 0; f < informative; f++)
+        {
+            x[f] += label * vertex[f];
+        }
+        y = u1 < flip_y ? -label : label;
+    }
+};
+
+// Drivers that fill a Dataset or stream rows to a CSV or binary file on several threads.
+// Files are written in blocks, so memory stays bounded for any number of rows.
+class Generators
+{
+private:
+    Generators() = delete;
+
+    // Rows generated (and formatted) per thread before a block is written out
+    static constexpr size_t rows_per_thread_block = 1 << 16;
+
+    static void fill(const DataGenerator &gen, Dataset &block, uint64_t first, size_t threads)
+    {
+        agrad::parallel_ranges(block.size(), threads, 1, [&](size_t, size_t begin, size_t end)
+                               {
+            for (size_t r = begin; r < end; r++)
+            {
+                gen.sample(first + r, block.row(r), block.label(r));
+            } });
+    }
+
+    static void append_number(std::string &out, double value)
+    {
+        char buffer[32];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, end);
+    }
+
+public:
+    // rows samples in memory
+    static Dataset generate(const DataGenerator &gen, size_t rows, size_t threads = 0)
+    {
+        agrad::trace::Scope span("generate", "data", static_cast<int64_t>(rows));
+        Dataset dataset(rows, gen.feature_dim());
+        fill(gen, dataset, 0, threads);
+        dataset.setInfo(gen.info());
+        return dataset;
+    }
+
+    // Streams rows samples to a CSV that DataLoader::load_dataset reads with the default
+    // schema (multiclass labels need LabelType::Multiclass). Numbers are written in their
+    // shortest round-trip form, and every thread formats its own rows.
+    static void write_csv(const DataGenerator &gen, size_t rows, const std::string &filename, size_t threads = 0)
+    {
+        agrad::trace::Scope span("write_csv", "data", static_cast<int64_t>(rows));
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        const DatasetInfo info = gen.info();
+        std::string header;
+        for (const auto &name : info.feature_names)
+        {
+            header += name + ",";
+        }
+        header += "label\n";
+        out << header;
+
+        threads = std::max<size_t>(1, std::min(agrad::thread_count(threads), rows));
+        const size_t dim = gen.feature_dim();
+        const bool named_labels = info.label_type == LabelType::Multiclass;
+        std::vector<std::string> text(threads);
+        Dataset block(std::min(rows, threads * rows_per_thread_block), dim);
+
+        for (size_t first = 0; first < rows; first += block.size())
+        {
+            const size_t n = std::min(block.size(), rows - first);
+            const size_t parts = agrad::parallel_ranges(n, threads, 1, [&](size_t t, size_t begin, size_t end)
+                                                        {
+                std::string &buffer = text[t];
+                buffer.clear();
+                for (size_t r = begin; r < end; r++)
+                {
+                    double *x = block.row(r);
+                    gen.sample(first + r, x, block.label(r));
+                    for (size_t f = 0; f < dim; f++)
+                    {
+                        append_number(buffer, x[f]);
+                        buffer += ',';
+                    }
+                    if (named_labels)
+                    {
+                        buffer += info.classes[static_cast<size_t>(block.label(r))];
+                    }
+                    else
+                    {
+                        append_number(buffer, block.label(r));
+                    }
+                    buffer += '\n';
+                } });
+            for (size_t t = 0; t < parts; t++)
+            {
+                out.write(text[t].data(), text[t].size());
+            }
+        }
+
+        if (!out.flush())
+        {
+            throw std::runtime_error("Failed writing file: " + filename);
+        }
+    }
+
+    // Streams rows samples into a BinaryDataset file
+    static void write_binary(const DataGenerator &gen, size_t rows, const std::string &filename,
+                             BinaryDataset::DType dtype = BinaryDataset::DType::F64, size_t threads = 0)
+    {
+        agrad::trace::Scope span("write_binary", "data", static_cast<int64_t>(rows));
+        threads = std::max<size_t>(1, std::min(agrad::thread_count(threads), rows));
+        BinaryDataset::Writer writer(filename, gen.feature_dim(), dtype);
+        Dataset block(std::min(rows, threads * rows_per_thread_block), gen.feature_dim());
+
+        for (size_t first = 0; first < rows; first += block.size())
+        {
+            const size_t n = std::min(block.size(), rows - first);
+            Dataset part = block.slice(0, n);
+            fill(gen, part, first, threads);
+            writer.append(part.data(), part.label_data(), n, part.getStride());
+        }
+        writer.finish(gen.info());
+    }
+
+    static Dataset make_moons(size_t rows, double noise = 0.1, uint64_t seed = 0, size_t threads = 0)
+    {
+        return generate(MoonsGenerator(noise, seed), rows, threads);
+    }
+
+    static Dataset make_circles(size_t rows, double noise = 0.1, double factor = 0.5, uint64_t seed = 0, size_t threads = 0)
+    {
+        return generate(CirclesGenerator(noise, factor, seed), rows, threads);
+    }
+
+    static Dataset make_blobs(size_t rows, size_t centers = 3, size_t features = 2, double cluster_std = 1.0, uint64_t seed = 0, size_t threads = 0)
+    {
+        return generate(BlobsGenerator(centers, features, cluster_std, 10.0, seed), rows, threads);
+    }
+
+    static Dataset make_classification(size_t rows, size_t features = 20, size_t informative = 2, double class_sep = 1.0,
+                                       double flip_y = 0.01, uint64_t seed = 0, size_t threads = 0)
+    {
+        return generate(ClassificationGenerator(features, informative, class_sep, flip_y, seed), rows, threads);
+    }
+};
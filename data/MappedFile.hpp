@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Memory mapping of a whole file. Pages are faulted in on first access, so "opening" a large
+// file costs a single mmap call. A copy-on-write mapping can be written to; written pages
+// become private copies and the file itself is never modified.
+class MappedFile
+{
+private:
+    const char *ptr = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string &filename, bool copy_on_write = false)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Unable to stat file: " + filename);
+        }
+
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0)
+        {
+            int protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+            void *mapped = ::mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Unable to map file: " + filename);
+            }
+            ptr = static_cast<const char *>(mapped);
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (ptr)
+        {
+            ::munmap(const_cast<char *>(ptr), length);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return ptr; }
+    // Only for copy-on-write mappings
+    char *mutable_data() const { return const_cast<char *>(ptr); }
+    size_t size() const { return length; }
+
+    // Hint that the file will be read front to back
+    void advise_sequential() const
+    {
+        if (ptr)
+        {
+            ::madvise(const_cast<char *>(ptr), length, MADV_SEQUENTIAL);
+        }
+    }
+};
@@ -0,0 +1,265 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ByteOrder.hpp"
+#include "Dataset.hpp"
+#include "MappedFile.hpp"
+
+// Per-feature count, mean, variance (Welford) and range, updated one row at a time so they
+// can be gathered while rows are parsed. Accumulators over disjoint rows merge exactly
+// (Chan et al.), which lets every loader thread keep its own.
+class FeatureStats
+{
+private:
+    uint64_t count = 0;
+    std::vector<double> mean_;
+    std::vector<double> m2; // sum of squared deviations from the mean
+    std::vector<double> min_;
+    std::vector<double> max_;
+
+    friend class Normalizer;
+
+public:
+    FeatureStats() = default;
+    explicit FeatureStats(size_t features)
+        : mean_(features, 0.0), m2(features, 0.0),
+          min_(features, std::numeric_limits<double>::infinity()),
+          max_(features, -std::numeric_limits<double>::infinity()) {}
+
+    // Statistics of every row of dataset
+    static FeatureStats of(const Dataset &dataset)
+    {
+        FeatureStats stats(dataset.feature_dim());
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            stats.add(dataset.row(i));
+        }
+        return stats;
+    }
+
+    void add(const double *row)
+    {
+        count++;
+        const double inv = 1.0 / static_cast<double>(count);
+        for (size_t f = 0; f < mean_.size(); f++)
+        {
+            const double x = row[f];
+            const double delta = x - mean_[f];
+            mean_[f] += delta * inv;
+            m2[f] += delta * (x - mean_[f]);
+            min_[f] = std::min(min_[f], x);
+            max_[f] = std::max(max_[f], x);
+        }
+    }
+
+    void merge(const FeatureStats &other)
+    {
+        if (other.count == 0)
+        {
+            return;
+        }
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+        if (other.mean_.size() != mean_.size())
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+
+        const double n_a = static_cast<double>(count);
+        const double n_b = static_cast<double>(other.count);
+        const double n = n_a + n_b;
+        for (size_t f = 0; f < mean_.size(); f++)
+        {
+            const double delta = other.mean_[f] - mean_[f];
+            mean_[f] += delta * n_b / n;
+            m2[f] += other.m2[f] + delta * delta * n_a * n_b / n;
+            min_[f] = std::min(min_[f], other.min_[f]);
+            max_[f] = std::max(max_[f], other.max_[f]);
+        }
+        count += other.count;
+    }
+
+    uint64_t getCount() const { return count; }
+    size_t feature_dim() const { return mean_.size(); }
+    double mean(size_t f) const { return mean_[f]; }
+    // Population variance
+    double variance(size_t f) const { return count ? m2[f] / static_cast<double>(count) : 0.0; }
+    double stddev(size_t f) const { return std::sqrt(variance(f)); }
+    double min(size_t f) const { return min_[f]; }
+    double max(size_t f) const { return max_[f]; }
+};
+
+enum class NormalizeMode
+{
+    Standard, // zero mean, unit variance
+    MinMax,   // [0, 1]
+};
+
+// Affine per-feature transform x' = (x - offset) * scale fitted from FeatureStats. Constant
+// features are only shifted. save() keeps the statistics with the model so that inference
+// inputs get exactly the transform the training data had.
+//
+// File layout, little-endian:
+//
+//   offset  0  char[8]  magic "AGRADNRM"
+//           8  u32      format version
+//          12  u32      mode (0 = standard, 1 = min-max)
+//          16  u32      features
+//          20  u32      reserved
+//          24  u64      rows the statistics were gathered from
+//          32  f64      mean, m2, min and max, features values each
+class Normalizer
+{
+public:
+    static constexpr uint32_t version = 1;
+
+private:
+    static constexpr char magic[8] = {'A', 'G', 'R', 'A', 'D', 'N', 'R', 'M'};
+    static constexpr size_t header_size = 32;
+
+    FeatureStats stats;
+    NormalizeMode mode;
+    std::vector<double> offset;
+    std::vector<double> scale;
+
+public:
+    Normalizer(FeatureStats stats, NormalizeMode mode = NormalizeMode::Standard)
+        : stats(std::move(stats)), mode(mode)
+    {
+        const size_t n = this->stats.feature_dim();
+        offset.resize(n);
+        scale.resize(n);
+        for (size_t f = 0; f < n; f++)
+        {
+            const double spread = mode == NormalizeMode::Standard ? this->stats.stddev(f) : this->stats.max(f) - this->stats.min(f);
+            offset[f] = mode == NormalizeMode::Standard ? this->stats.mean(f) : this->stats.min(f);
+            scale[f] = spread > 0.0 && std::isfinite(spread) ? 1.0 / spread : 1.0;
+        }
+    }
+
+    size_t feature_dim() const { return offset.size(); }
+    NormalizeMode getMode() const { return mode; }
+    const FeatureStats &getStats() const { return stats; }
+    double getOffset(size_t f) const { return offset[f]; }
+    double getScale(size_t f) const { return scale[f]; }
+
+    void apply(double *row) const
+    {
+        for (size_t f = 0; f < offset.size(); f++)
+        {
+            row[f] = (row[f] - offset[f]) * scale[f];
+        }
+    }
+
+    // Normalizes every row of the view in place, which the rest of its storage shares
+    void apply(Dataset &dataset) const
+    {
+        if (dataset.feature_dim() != feature_dim())
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            apply(dataset.row(i));
+        }
+    }
+
+    std::vector<double> transform(std::vector<double> x) const
+    {
+        if (x.size() != feature_dim())
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+        apply(x.data());
+        return x;
+    }
+
+    // Maps a normalized row back to the original units
+    void invert(double *row) const
+    {
+        for (size_t f = 0; f < offset.size(); f++)
+        {
+            row[f] = row[f] / scale[f] + offset[f];
+        }
+    }
+
+    void save(const std::string &filename) const
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        out.write(magic, sizeof(magic));
+        byte_order::write_le<uint32_t>(out, version);
+        byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(mode));
+        byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(feature_dim()));
+        byte_order::write_le<uint32_t>(out, 0);
+        byte_order::write_le<uint64_t>(out, stats.count);
+        for (const auto *values : {&stats.mean_, &stats.m2, &stats.min_, &stats.max_})
+        {
+            for (double v : *values)
+            {
+                byte_order::write_le<double>(out, v);
+            }
+        }
+
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing normalizer: " + filename);
+        }
+    }
+
+    static Normalizer load(const std::string &filename)
+    {
+        MappedFile file(filename);
+        const char *data = file.data();
+        auto invalid = [&](const std::string &reason)
+        {
+            return std::runtime_error("Invalid normalizer " + filename + ": " + reason);
+        };
+
+        if (file.size() < header_size || std::memcmp(data, magic, sizeof(magic)) != 0)
+        {
+            throw invalid("bad magic");
+        }
+        if (byte_order::read_le<uint32_t>(data + 8) != version)
+        {
+            throw invalid("unsupported version " + std::to_string(byte_order::read_le<uint32_t>(data + 8)));
+        }
+        const uint32_t mode = byte_order::read_le<uint32_t>(data + 12);
+        const uint32_t features = byte_order::read_le<uint32_t>(data + 16);
+        if (mode > static_cast<uint32_t>(NormalizeMode::MinMax))
+        {
+            throw invalid("unknown mode");
+        }
+        if (file.size() != header_size + 4 * sizeof(double) * static_cast<size_t>(features))
+        {
+            throw invalid("size does not match the header");
+        }
+
+        FeatureStats stats(features);
+        stats.count = byte_order::read_le<uint64_t>(data + 24);
+        const char *p = data + header_size;
+        for (auto *values : {&stats.mean_, &stats.m2, &stats.min_, &stats.max_})
+        {
+            for (double &v : *values)
+            {
+                v = byte_order::read_le<double>(p);
+                p += sizeof(double);
+            }
+        }
+        return Normalizer(std::move(stats), static_cast<NormalizeMode>(mode));
+    }
+};
@@ -0,0 +1,91 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "data/BinaryDataset.hpp"
+
+// Converts a CSV dataset into the binary format read by BinaryDataset::load
+static void usage()
+{
+    std::cerr << "Usage: csv2bin <input.csv> <output.bin> [options]\n"
+              << "  --features a,b,c     feature columns (default: all but the label)\n"
+              << "  --label NAME         label column (default: label)\n"
+              << "  --label-type TYPE    binary, regression or multiclass (default: binary)\n"
+              << "  --delimiter C        field delimiter (default: ,)\n"
+              << "  --float32            store values as f32 instead of f64\n"
+              << "  --no-checksum        skip the checksum\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        usage();
+        return 1;
+    }
+
+    DatasetSchema schema;
+    BinaryDataset::DType dtype = BinaryDataset::DType::F64;
+    bool with_checksum = true;
+
+    for (int i = 3; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--features" && has_value)
+        {
+            std::stringstream names(argv[++i]);
+            for (std::string name; std::getline(names, name, ',');)
+            {
+                schema.features.push_back(name);
+            }
+        }
+        else if (arg == "--label" && has_value)
+        {
+            schema.label = argv[++i];
+        }
+        else if (arg == "--label-type" && has_value)
+        {
+            std::string type = argv[++i];
+            if (type == "binary")
+                schema.label_type = LabelType::Binary;
+            else if (type == "regression")
+                schema.label_type = LabelType::Regression;
+            else if (type == "multiclass")
+                schema.label_type = LabelType::Multiclass;
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--delimiter" && has_value && std::strlen(argv[i + 1]) == 1)
+        {
+            schema.delimiter = argv[++i][0];
+        }
+        else if (arg == "--float32")
+        {
+            dtype = BinaryDataset::DType::F32;
+        }
+        else if (arg == "--no-checksum")
+        {
+            with_checksum = false;
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    try
+    {
+        size_t rows = BinaryDataset::convert_csv(argv[1], argv[2], schema, dtype, with_checksum);
+        std::cout << "Wrote " << rows << " rows to " << argv[2] << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "csv2bin: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include "data/Generators.hpp"
+
+// Writes a synthetic dataset to CSV or, for a .bin output, to a BinaryDataset file
+static void usage()
+{
+    std::cerr << "Usage: gen_data <moons|circles|blobs|classification> <rows> <output.csv|output.bin> [options]\n"
+              << "  --seed N             random seed (default: 0)\n"
+              << "  --noise X            moons and circles noise (default: 0.1)\n"
+              << "  --factor X           circles inner radius (default: 0.5)\n"
+              << "  --centers N          blobs clusters (default: 3)\n"
+              << "  --features N         blobs and classification features (default: 2 and 20)\n"
+              << "  --informative N      classification informative features (default: 2)\n"
+              << "  --threads N          threads (default: one per core)\n"
+              << "  --float32            store a .bin output as f32\n";
+}
+
+static bool ends_with(const std::string &s, const std::string &suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        usage();
+        return 1;
+    }
+
+    const std::string kind = argv[1];
+    const std::string output = argv[3];
+    uint64_t seed = 0;
+    double noise = 0.1, factor = 0.5;
+    size_t centers = 3, features = 0, informative = 2, threads = 0;
+    BinaryDataset::DType dtype = BinaryDataset::DType::F64;
+
+    try
+    {
+        const size_t rows = std::stoull(argv[2]);
+        for (int i = 4; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            if (arg == "--float32")
+                dtype = BinaryDataset::DType::F32;
+            else if (arg == "--seed" && has_value)
+                seed = std::stoull(argv[++i]);
+            else if (arg == "--noise" && has_value)
+                noise = std::stod(argv[++i]);
+            else if (arg == "--factor" && has_value)
+                factor = std::stod(argv[++i]);
+            else if (arg == "--centers" && has_value)
+                centers = std::stoull(argv[++i]);
+            else if (arg == "--features" && has_value)
+                features = std::stoull(argv[++i]);
+            else if (arg == "--informative" && has_value)
+                informative = std::stoull(argv[++i]);
+            else if (arg == "--threads" && has_value)
+                threads = std::stoull(argv[++i]);
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+
+        std::unique_ptr<DataGenerator> gen;
+        if (kind == "moons")
+            gen = std::make_unique<MoonsGenerator>(noise, seed);
+        else if (kind == "circles")
+            gen = std::make_unique<CirclesGenerator>(noise, factor, seed);
+        else if (kind == "blobs")
+            gen = std::make_unique<BlobsGenerator>(centers, features ? features : 2, 1.0, 10.0, seed);
+        else if (kind == "classification")
+            gen = std::make_unique<ClassificationGenerator>(features ? features : 20, informative, 1.0, 0.01, seed);
+        else
+        {
+            usage();
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (ends_with(output, ".bin"))
+        {
+            Generators::write_binary(*gen, rows, output, dtype, threads);
+        }
+        else
+        {
+            Generators::write_csv(*gen, rows, output, threads);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << rows << " rows to " << output << " in " << seconds << " s" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "gen_data: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
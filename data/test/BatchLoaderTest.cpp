@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include "data/BatchLoader.hpp"
+
+class BatchLoaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Row i is {i, 2i} with label i, so a batch row tells which dataset row it came from
+        for (int i = 0; i < 103; i++)
+        {
+            dataset.push_back({double(i), 2.0 * i}, i);
+        }
+    }
+
+    // Rows of one epoch in the order they were served, checking each batch on the way
+    static std::vector<double> epoch_rows(BatchLoader &loader, std::vector<size_t> *sizes = nullptr)
+    {
+        std::vector<double> rows;
+        size_t expected_index = 0;
+        for (const MiniBatch &batch : loader)
+        {
+            EXPECT_EQ(batch.index, expected_index++);
+            EXPECT_EQ(batch.x.size(), batch.size());
+            for (size_t i = 0; i < batch.size(); i++)
+            {
+                EXPECT_EQ(batch.x[i], (std::vector<double>{batch.y[i], 2.0 * batch.y[i]}));
+                rows.push_back(batch.y[i]);
+            }
+            if (sizes)
+            {
+                sizes->push_back(batch.size());
+            }
+        }
+        EXPECT_EQ(expected_index, loader.batches_per_epoch());
+        return rows;
+    }
+
+    static std::vector<double> in_order(size_t n)
+    {
+        std::vector<double> rows(n);
+        std::iota(rows.begin(), rows.end(), 0.0);
+        return rows;
+    }
+
+    Dataset dataset;
+};
+
+TEST_F(BatchLoaderTest, InOrderWithoutShuffle)
+{
+    BatchLoaderOptions options;
+    options.batch_size = 25;
+    options.shuffle = false;
+    BatchLoader loader(dataset, options);
+
+    std::vector<size_t> sizes;
+    EXPECT_EQ(epoch_rows(loader, &sizes), in_order(103));
+    EXPECT_EQ(sizes, (std::vector<size_t>{25, 25, 25, 25, 3}));
+
+    options.drop_last = true;
+    BatchLoader dropping(dataset, options);
+    EXPECT_EQ(dropping.batches_per_epoch(), 4);
+    EXPECT_EQ(epoch_rows(dropping), in_order(100));
+}
+
+TEST_F(BatchLoaderTest, ShufflesEveryEpoch)
+{
+    BatchLoaderOptions options;
+    options.batch_size = 8;
+    options.seed = 11;
+    options.workers = 3;
+    options.prefetch = 4;
+    BatchLoader loader(dataset, options);
+
+    std::vector<double> first = epoch_rows(loader);
+    std::vector<double> second = epoch_rows(loader);
+    EXPECT_EQ(loader.getEpoch(), 2);
+    EXPECT_NE(first, in_order(103));
+    EXPECT_NE(first, second);
+
+    std::sort(first.begin(), first.end());
+    std::sort(second.begin(), second.end());
+    EXPECT_EQ(first, in_order(103));
+    EXPECT_EQ(second, in_order(103));
+}
+
+TEST_F(BatchLoaderTest, SameOrderForAnyWorkerCount)
+{
+    BatchLoaderOptions options;
+    options.batch_size = 7;
+    options.seed = 5;
+
+    std::vector<std::vector<double>> runs;
+    for (size_t workers : {0, 1, 4})
+    {
+        options.workers = workers;
+        options.prefetch = workers;
+        BatchLoader loader(dataset, options);
+        std::vector<double> rows = epoch_rows(loader);
+        std::vector<double> next = epoch_rows(loader);
+        rows.insert(rows.end(), next.begin(), next.end());
+        runs.push_back(rows);
+    }
+    EXPECT_EQ(runs[0], runs[1]);
+    EXPECT_EQ(runs[0], runs[2]);
+}
+
+TEST_F(BatchLoaderTest, AbandonedEpoch)
+{
+    BatchLoaderOptions options;
+    options.batch_size = 10;
+    options.workers = 2;
+    BatchLoader loader(dataset, options);
+
+    ASSERT_NE(loader.next(), nullptr);
+    ASSERT_NE(loader.next(), nullptr);
+    loader.start_epoch();
+    EXPECT_EQ(loader.getEpoch(), 1);
+
+    std::vector<double> rows;
+    while (const MiniBatch *batch = loader.next())
+    {
+        rows.insert(rows.end(), batch->y.begin(), batch->y.end());
+    }
+    std::sort(rows.begin(), rows.end());
+    EXPECT_EQ(rows, in_order(103));
+    EXPECT_EQ(loader.getEpoch(), 2);
+
+    EXPECT_THROW(BatchLoader(dataset, BatchLoaderOptions{0}), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "data/BinaryDataset.hpp"
+
+class BinaryDatasetTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto dir = std::filesystem::temp_directory_path();
+        csv_path = (dir / "agrad_binary_test.csv").string();
+        bin_path = (dir / "agrad_binary_test.bin").string();
+
+        std::ofstream out(csv_path, std::ios::binary | std::ios::trunc);
+        out << "x1,x2,x3,kind\n";
+        for (int i = 0; i < 50; i++)
+        {
+            out << i * 0.1 << "," << -i << ",skip," << (i % 3 == 0 ? "cat" : i % 3 == 1 ? "dog" : "fox") << "\n";
+        }
+        schema.features = {"x2", "x1"};
+        schema.label = "kind";
+        schema.label_type = LabelType::Multiclass;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(csv_path);
+        std::filesystem::remove(bin_path);
+    }
+
+    static void expect_same(const Dataset &a, const Dataset &b)
+    {
+        ASSERT_EQ(a.size(), b.size());
+        ASSERT_EQ(a.feature_dim(), b.feature_dim());
+        EXPECT_EQ(a.getFeatureNames(), b.getFeatureNames());
+        EXPECT_EQ(a.getClasses(), b.getClasses());
+        EXPECT_EQ(a.getLabelType(), b.getLabelType());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            EXPECT_EQ(a.row_vector(i), b.row_vector(i));
+            EXPECT_EQ(a.label(i), b.label(i));
+        }
+    }
+
+    std::string csv_path;
+    std::string bin_path;
+    DatasetSchema schema;
+};
+
+TEST_F(BinaryDatasetTest, ConvertMatchesCsv)
+{
+    Dataset csv = DataLoader::load_dataset(csv_path, schema);
+    EXPECT_EQ(BinaryDataset::convert_csv(csv_path, bin_path, schema), 50);
+    EXPECT_TRUE(BinaryDataset::is_binary(bin_path));
+    EXPECT_FALSE(BinaryDataset::is_binary(csv_path));
+
+    Dataset loaded = BinaryDataset::load(bin_path, true);
+    expect_same(csv, loaded);
+    EXPECT_EQ(loaded.getClasses(), (std::vector<std::string>{"cat", "dog", "fox"}));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded.data()) % BinaryDataset::block_alignment, 0);
+}
+
+TEST_F(BinaryDatasetTest, SaveViewsAndFloat32)
+{
+    Dataset csv = DataLoader::load_dataset(csv_path, schema);
+    Dataset picked = csv.select({7, 3, 40});
+    BinaryDataset::save(picked, bin_path);
+    expect_same(picked.materialize(), BinaryDataset::load(bin_path));
+
+    BinaryDataset::save(csv, bin_path, BinaryDataset::DType::F32);
+    Dataset narrow = BinaryDataset::load(bin_path, true);
+    ASSERT_EQ(narrow.size(), csv.size());
+    for (size_t i = 0; i < csv.size(); i++)
+    {
+        EXPECT_FLOAT_EQ(narrow.row(i)[1], csv.row(i)[1]);
+        EXPECT_EQ(narrow.label(i), csv.label(i));
+    }
+}
+
+TEST_F(BinaryDatasetTest, MappingIsCopyOnWrite)
+{
+    BinaryDataset::convert_csv(csv_path, bin_path, schema);
+    {
+        Dataset loaded = BinaryDataset::load(bin_path);
+        EXPECT_THROW(loaded.push_back({0.0, 0.0}, 0.0), std::logic_error);
+        loaded.row(5)[0] = 1234.0;
+        loaded.label(5) = 2.0;
+        EXPECT_EQ(loaded.slice(5, 6).row(0)[0], 1234.0);
+    }
+    Dataset reloaded = BinaryDataset::load(bin_path, true);
+    EXPECT_EQ(reloaded.row(5)[0], -5.0);
+    EXPECT_EQ(reloaded.label(5), 2.0);
+}
+
+TEST_F(BinaryDatasetTest, DetectsCorruption)
+{
+    BinaryDataset::convert_csv(csv_path, bin_path, schema);
+    {
+        std::fstream file(bin_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(200);
+        file.put('\x7f');
+    }
+    EXPECT_NO_THROW(BinaryDataset::load(bin_path));
+    try
+    {
+        BinaryDataset::load(bin_path, true);
+        FAIL() << "expected a checksum error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Invalid dataset " + bin_path + ": checksum mismatch");
+    }
+
+    // Truncated file
+    std::filesystem::resize_file(bin_path, 300);
+    EXPECT_THROW(BinaryDataset::load(bin_path), std::runtime_error);
+    try
+    {
+        BinaryDataset::load(csv_path);
+        FAIL() << "expected a format error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Invalid dataset " + csv_path + ": bad magic");
+    }
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "data/DataLoader.hpp"
+
+class DataLoaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = (std::filesystem::temp_directory_path() / "agrad_dataloader_test.csv").string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    void write(const std::string &contents)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << contents;
+    }
+
+    // Message of the error load_dataset throws, or "" if it loads
+    std::string load_error(const std::string &contents)
+    {
+        write(contents);
+        try
+        {
+            DataLoader::load_dataset(path);
+        }
+        catch (const std::runtime_error &e)
+        {
+            return e.what();
+        }
+        return "";
+    }
+
+    std::string path;
+};
+
+TEST_F(DataLoaderTest, LoadsRows)
+{
+    write("x1,x2,label\n0.5,-1.25,1\n3e-2, 4 ,-1.0\r\n+7,8,1");
+    Dataset dataset = DataLoader::load_dataset(path);
+
+    ASSERT_EQ(dataset.size(), 3);
+    ASSERT_EQ(dataset.label_vector().size(), 3);
+    EXPECT_DOUBLE_EQ(dataset.row(0)[0], 0.5);
+    EXPECT_DOUBLE_EQ(dataset.row(0)[1], -1.25);
+    EXPECT_DOUBLE_EQ(dataset.row(1)[0], 0.03);
+    EXPECT_DOUBLE_EQ(dataset.row(1)[1], 4.0);
+    EXPECT_DOUBLE_EQ(dataset.row(2)[0], 7.0);
+    EXPECT_EQ(dataset.label_vector(), (std::vector<double>{1.0, -1.0, 1.0}));
+}
+
+TEST_F(DataLoaderTest, Errors)
+{
+    EXPECT_EQ(load_error("a,b,c\n1,2,1\n"), "Invalid file format: no column named 'label'");
+    EXPECT_EQ(load_error("x1,x1,label\n1,2,1\n"), "Invalid file format: duplicate column 'x1'");
+    EXPECT_EQ(load_error("x1,x2,label\n"), "No data found in file");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2,1\n\n"), "Missing value in line 2");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2,1\n1\n"), "Missing value in line 2");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2,1\n1,2,1\n1,x,1\n"), "Invalid number format in line 3: x");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2.5.1,1\n"), "Invalid number format in line 1: 2.5.1");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2\n"), "Missing label in line 1");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2,0.5\n"), "Invalid label format in line 1: 0.5");
+    EXPECT_EQ(load_error("x1,x2,label\n1,2,one\n"), "Invalid label format in line 1: one");
+
+    EXPECT_THROW(DataLoader::load_dataset(path + ".missing"), std::runtime_error);
+    write("");
+    EXPECT_THROW(DataLoader::load_dataset(path), std::runtime_error);
+}
+
+TEST_F(DataLoaderTest, InfersSchemaFromHeader)
+{
+    write("label,a,b,c\n1,0.5,1.5,2.5\n-1,3,4,5\n");
+    Dataset dataset = DataLoader::load_dataset(path);
+
+    EXPECT_EQ(dataset.getFeatureNames(), (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(dataset.feature_dim(), 3);
+    EXPECT_EQ(dataset.row_vector(1), (std::vector<double>{3.0, 4.0, 5.0}));
+    EXPECT_EQ(dataset.label_vector(), (std::vector<double>{1.0, -1.0}));
+}
+
+TEST_F(DataLoaderTest, SelectsColumns)
+{
+    // Unselected columns are never parsed, so garbage in them is fine
+    write("id,b,junk,a,target,tail\n7,2.0,??,1.0,0.25,??\n8,4.0,??,3.0,-1.5\n");
+    DatasetSchema schema;
+    schema.features = {"a", "b"};
+    schema.label = "target";
+    schema.label_type = LabelType::Regression;
+    Dataset dataset = DataLoader::load_dataset(path, schema);
+
+    EXPECT_EQ(dataset.getFeatureNames(), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(dataset.row_vector(0), (std::vector<double>{1.0, 2.0}));
+    EXPECT_EQ(dataset.row_vector(1), (std::vector<double>{3.0, 4.0}));
+    EXPECT_EQ(dataset.label_vector(), (std::vector<double>{0.25, -1.5}));
+
+    schema.features = {"a", "missing"};
+    EXPECT_THROW(DataLoader::load_dataset(path, schema), std::runtime_error);
+    schema.features = {"a", "target"};
+    EXPECT_THROW(DataLoader::load_dataset(path, schema), std::invalid_argument);
+}
+
+TEST_F(DataLoaderTest, MulticlassLabels)
+{
+    write("x;\"species\"\n1;setosa\n2;virginica\n3; setosa\n4;versicolor\n");
+    DatasetSchema schema;
+    schema.label = "species";
+    schema.label_type = LabelType::Multiclass;
+    schema.delimiter = ';';
+    Dataset dataset = DataLoader::load_dataset(path, schema);
+
+    EXPECT_EQ(dataset.getClasses(), (std::vector<std::string>{"setosa", "virginica", "versicolor"}));
+    EXPECT_EQ(dataset.label_vector(), (std::vector<double>{0.0, 1.0, 0.0, 2.0}));
+
+    auto [train, test] = DataLoader::train_test_split(dataset, 0.5);
+    EXPECT_EQ(test.getClasses(), dataset.getClasses());
+    EXPECT_EQ(test.getFeatureNames(), (std::vector<std::string>{"x"}));
+}
+
+TEST_F(DataLoaderTest, ParallelMatchesSequential)
+{
+    // Classes first appear late in the file, so chunks number them differently
+    std::string contents = "x,kind\r\n";
+    const char *kinds[] = {"a", "b", "c", "d"};
+    for (int i = 0; i < 300; i++)
+    {
+        contents += std::to_string(i) + "," + kinds[i < 100 ? i % 2 : (i < 250 ? 2 + i % 2 : i % 4)] + "\r\n";
+    }
+    contents += "300,d";
+    write(contents);
+
+    DatasetSchema schema;
+    schema.label = "kind";
+    schema.label_type = LabelType::Multiclass;
+    Dataset sequential = DataLoader::load_dataset(path, schema, 1);
+    ASSERT_EQ(sequential.size(), 301);
+
+    for (size_t threads : {2, 3, 7, 64, 1000})
+    {
+        Dataset parallel = DataLoader::load_dataset(path, schema, threads);
+        ASSERT_EQ(parallel.size(), sequential.size());
+        EXPECT_EQ(parallel.getClasses(), (std::vector<std::string>{"a", "b", "c", "d"}));
+        EXPECT_EQ(parallel.label_vector(), sequential.label_vector());
+        for (size_t i = 0; i < parallel.size(); i++)
+        {
+            EXPECT_EQ(parallel.row(i)[0], double(i));
+        }
+    }
+}
+
+TEST_F(DataLoaderTest, ParallelReportsFirstError)
+{
+    std::string contents = "x,label\n";
+    for (int i = 1; i <= 400; i++)
+    {
+        contents += i == 150 ? "oops,1\n" : i == 390 ? "1\n" : std::to_string(i) + ",1\n";
+    }
+    write(contents);
+
+    for (size_t threads : {1, 2, 4, 16})
+    {
+        try
+        {
+            DataLoader::load_dataset(path, {}, threads);
+            FAIL() << "expected an error";
+        }
+        catch (const std::runtime_error &e)
+        {
+            EXPECT_STREQ(e.what(), "Invalid number format in line 150: oops");
+        }
+    }
+}
+
+TEST_F(DataLoaderTest, CsvParserLines)
+{
+    std::string text = "a\r\nb\n\nc";
+    CsvParser parser(text.data(), text.data() + text.size());
+    std::string_view line;
+    std::vector<std::string> lines;
+    while (parser.next_line(line))
+    {
+        lines.emplace_back(line);
+    }
+    EXPECT_EQ(lines, (std::vector<std::string>{"a", "b", "", "c"}));
+    EXPECT_EQ(parser.getLineNumber(), 4);
+    EXPECT_EQ(CsvParser::count_lines(text.data(), text.data() + text.size()), 4);
+    EXPECT_EQ(CsvParser::count_lines(text.data(), text.data() + 3), 1);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include "data/DatasetStream.hpp"
+
+class DatasetStreamTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = (std::filesystem::temp_directory_path() / "agrad_stream_test.csv").string();
+        // Row i is {i, -i} with regression target i
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "a,b,label\n";
+        for (int i = 0; i < rows; i++)
+        {
+            out << i << "," << -i << "," << i << "\n";
+        }
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    // Labels of one epoch, checking every row against its label
+    std::vector<double> epoch_labels(DatasetStream &stream)
+    {
+        std::vector<double> labels;
+        for (const Dataset &batch : stream)
+        {
+            for (size_t i = 0; i < batch.size(); i++)
+            {
+                EXPECT_DOUBLE_EQ(batch.row(i)[0], batch.label(i));
+                EXPECT_DOUBLE_EQ(batch.row(i)[1], -batch.label(i));
+                labels.push_back(batch.label(i));
+            }
+        }
+        return labels;
+    }
+
+    static std::vector<double> file_order()
+    {
+        std::vector<double> labels(rows);
+        for (int i = 0; i < rows; i++)
+        {
+            labels[i] = i;
+        }
+        return labels;
+    }
+
+    static constexpr int rows = 100;
+    std::string path;
+    DatasetSchema schema{{}, "label", LabelType::Regression, ','};
+};
+
+TEST_F(DatasetStreamTest, BatchesInFileOrder)
+{
+    // Chunks smaller than a line force refills and buffer growth mid-line
+    StreamOptions options;
+    options.batch_size = 16;
+    options.chunk_bytes = 4;
+    DatasetStream stream(path, schema, options);
+    EXPECT_EQ(stream.feature_dim(), 2);
+    EXPECT_EQ(stream.getInfo().feature_names, (std::vector<std::string>{"a", "b"}));
+
+    Dataset batch;
+    std::vector<size_t> sizes;
+    while (stream.next(batch))
+    {
+        sizes.push_back(batch.size());
+    }
+    EXPECT_EQ(sizes, (std::vector<size_t>{16, 16, 16, 16, 16, 16, 4}));
+    EXPECT_EQ(stream.getEpoch(), 1);
+    EXPECT_EQ(epoch_labels(stream), file_order());
+}
+
+TEST_F(DatasetStreamTest, DropLast)
+{
+    StreamOptions options;
+    options.batch_size = 16;
+    options.drop_last = true;
+    DatasetStream stream(path, schema, options);
+
+    std::vector<double> labels = epoch_labels(stream);
+    ASSERT_EQ(labels.size(), 96);
+    EXPECT_EQ(labels.back(), 95.0);
+}
+
+TEST_F(DatasetStreamTest, ShuffleWindow)
+{
+    StreamOptions options;
+    options.batch_size = 8;
+    options.chunk_bytes = 64;
+    options.shuffle_window = 20;
+    options.seed = 3;
+    DatasetStream stream(path, schema, options);
+
+    std::vector<double> first = epoch_labels(stream);
+    std::vector<double> second = epoch_labels(stream);
+    EXPECT_EQ(stream.getEpoch(), 2);
+    EXPECT_NE(first, file_order());
+    EXPECT_NE(first, second);
+
+    // Every row is seen exactly once per epoch and never leaves the window early
+    for (size_t i = 0; i < first.size(); i++)
+    {
+        EXPECT_LE(first[i], i + options.shuffle_window);
+    }
+    std::sort(first.begin(), first.end());
+    std::sort(second.begin(), second.end());
+    EXPECT_EQ(first, file_order());
+    EXPECT_EQ(second, file_order());
+
+    // The same seed replays the same order
+    DatasetStream again(path, schema, options);
+    DatasetStream replay(path, schema, options);
+    EXPECT_EQ(epoch_labels(again), epoch_labels(replay));
+}
+
+TEST_F(DatasetStreamTest, Errors)
+{
+    EXPECT_THROW(DatasetStream(path, schema, StreamOptions{0}), std::invalid_argument);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "1,2\n";
+    }
+    StreamOptions options;
+    options.chunk_bytes = 16;
+    DatasetStream stream(path, schema, options);
+    try
+    {
+        epoch_labels(stream);
+        FAIL() << "expected an error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_STREQ(e.what(), "Missing label in line 101");
+    }
+}
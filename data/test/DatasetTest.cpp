@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "data/DataLoader.hpp"
+
+class DatasetTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Row i is {i, 10 * i} with label i
+        for (int i = 0; i < 10; i++)
+        {
+            dataset.push_back({double(i), 10.0 * i}, i);
+        }
+    }
+
+    Dataset dataset;
+};
+
+TEST_F(DatasetTest, ContiguousStorage)
+{
+    ASSERT_EQ(dataset.size(), 10);
+    EXPECT_EQ(dataset.feature_dim(), 2);
+    EXPECT_EQ(dataset.getStride(), 2);
+    EXPECT_TRUE(dataset.is_contiguous());
+    EXPECT_EQ(dataset.row(3), dataset.data() + 6);
+    EXPECT_DOUBLE_EQ(dataset.row(3)[1], 30.0);
+    EXPECT_DOUBLE_EQ(dataset.label_data()[7], 7.0);
+    EXPECT_THROW(dataset.push_back({1.0}, 0.0), std::invalid_argument);
+}
+
+TEST_F(DatasetTest, SliceSharesStorage)
+{
+    Dataset view = dataset.slice(2, 6);
+    ASSERT_EQ(view.size(), 4);
+    EXPECT_EQ(view.row(0), dataset.row(2));
+    EXPECT_EQ(view.data(), dataset.row(2));
+    EXPECT_DOUBLE_EQ(view.label(3), 5.0);
+
+    Dataset inner = view.slice(1, 3);
+    EXPECT_EQ(inner.row(0), dataset.row(3));
+    EXPECT_THROW(view.slice(2, 5), std::out_of_range);
+    EXPECT_THROW(view.push_back({0.0, 0.0}, 0.0), std::logic_error);
+
+    // Writes are visible through every view
+    view.row(0)[0] = -1.0;
+    EXPECT_DOUBLE_EQ(dataset.row(2)[0], -1.0);
+}
+
+TEST_F(DatasetTest, SelectBuildsIndexView)
+{
+    Dataset picked = dataset.slice(4, 10).select({5, 0, 2});
+    ASSERT_EQ(picked.size(), 3);
+    EXPECT_FALSE(picked.is_contiguous());
+    EXPECT_EQ(picked.data(), nullptr);
+    EXPECT_EQ(picked.row(0), dataset.row(9));
+    EXPECT_EQ(picked.row(1), dataset.row(4));
+    EXPECT_EQ(picked.label_vector(), (std::vector<double>{9.0, 4.0, 6.0}));
+
+    Dataset tail = picked.slice(1, 3);
+    EXPECT_EQ(tail.row(0), dataset.row(4));
+    EXPECT_THROW(picked.select({3}), std::out_of_range);
+
+    Dataset copy = picked.materialize();
+    EXPECT_TRUE(copy.is_contiguous());
+    EXPECT_NE(copy.row(0), dataset.row(9));
+    EXPECT_EQ(copy.row_vector(2), (std::vector<double>{6.0, 60.0}));
+    copy.row(0)[0] = 100.0;
+    EXPECT_DOUBLE_EQ(dataset.row(9)[0], 9.0);
+}
+
+TEST_F(DatasetTest, TrainTestSplitIsZeroCopy)
+{
+    auto [train, test] = DataLoader::train_test_split(dataset, 0.8);
+    EXPECT_EQ(train.size(), 8);
+    EXPECT_EQ(test.size(), 2);
+    EXPECT_EQ(train.data(), dataset.data());
+    EXPECT_EQ(test.data(), dataset.row(8));
+
+    auto [small_train, small_test] = DataLoader::train_test_split(dataset, 0.5, 4);
+    EXPECT_EQ(small_train.size(), 2);
+    EXPECT_EQ(small_test.size(), 2);
+    EXPECT_EQ(small_test.row(1), dataset.row(3));
+}
+
+TEST_F(DatasetTest, SetInfoStaysOnTheView)
+{
+    dataset.setInfo({{"a", "b"}, LabelType::Regression, {}});
+    Dataset view = dataset.slice(0, 5);
+    Dataset copy = dataset;
+
+    view.setInfo({{"c", "d"}, LabelType::Multiclass, {"x", "y"}});
+    EXPECT_EQ(view.getFeatureNames(), (std::vector<std::string>{"c", "d"}));
+    EXPECT_EQ(view.getLabelType(), LabelType::Multiclass);
+    EXPECT_EQ(dataset.getFeatureNames(), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(dataset.getLabelType(), LabelType::Regression);
+    EXPECT_EQ(copy.getFeatureNames(), (std::vector<std::string>{"a", "b"}));
+    EXPECT_TRUE(copy.getClasses().empty());
+
+    // Rows are still shared
+    EXPECT_EQ(view.data(), dataset.data());
+}
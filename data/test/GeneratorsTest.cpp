@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include "data/Generators.hpp"
+
+class GeneratorsTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    static void expect_same(const Dataset &a, const Dataset &b)
+    {
+        ASSERT_EQ(a.size(), b.size());
+        ASSERT_EQ(a.feature_dim(), b.feature_dim());
+        EXPECT_EQ(a.getFeatureNames(), b.getFeatureNames());
+        EXPECT_EQ(a.getClasses(), b.getClasses());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            ASSERT_EQ(a.row_vector(i), b.row_vector(i)) << "row " << i;
+            ASSERT_EQ(a.label(i), b.label(i)) << "row " << i;
+        }
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / "agrad_generators_test").string();
+};
+
+TEST_F(GeneratorsTest, SameDataForAnyThreadCount)
+{
+    Dataset one = Generators::make_moons(1001, 0.2, 9, 1);
+    expect_same(one, Generators::make_moons(1001, 0.2, 9, 4));
+    expect_same(one.slice(0, 100), Generators::make_moons(100, 0.2, 9, 3));
+
+    Dataset other = Generators::make_moons(1001, 0.2, 10, 1);
+    EXPECT_NE(one.row_vector(0), other.row_vector(0));
+}
+
+TEST_F(GeneratorsTest, ShapesWithoutNoise)
+{
+    Dataset moons = Generators::make_moons(2000, 0.0, 1);
+    Dataset circles = Generators::make_circles(2000, 0.0, 0.3, 1);
+    double positives = 0.0;
+    for (size_t i = 0; i < moons.size(); i++)
+    {
+        const double *m = moons.row(i);
+        const double *c = circles.row(i);
+        if (moons.label(i) == 1.0)
+        {
+            EXPECT_NEAR(std::hypot(m[0] - 1.0, m[1] - 0.5), 1.0, 1e-12);
+            EXPECT_LE(m[1], 0.5 + 1e-12);
+            positives++;
+        }
+        else
+        {
+            EXPECT_EQ(moons.label(i), -1.0);
+            EXPECT_NEAR(std::hypot(m[0], m[1]), 1.0, 1e-12);
+            EXPECT_GE(m[1], -1e-12);
+        }
+        EXPECT_NEAR(std::hypot(c[0], c[1]), circles.label(i) == 1.0 ? 0.3 : 1.0, 1e-12);
+    }
+    EXPECT_NEAR(positives / moons.size(), 0.5, 0.05);
+}
+
+TEST_F(GeneratorsTest, BlobsAndClassification)
+{
+    BlobsGenerator blobs(4, 3, 0.5, 10.0, 2);
+    Dataset data = Generators::generate(blobs, 4000);
+    EXPECT_EQ(data.getLabelType(), LabelType::Multiclass);
+    EXPECT_EQ(data.getClasses().size(), 4);
+    EXPECT_EQ(data.getFeatureNames(), (std::vector<std::string>{"x1", "x2", "x3"}));
+    std::vector<double> sums(12, 0.0), counts(4, 0.0);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        size_t c = static_cast<size_t>(data.label(i));
+        ASSERT_LT(c, 4);
+        counts[c]++;
+        for (size_t f = 0; f < 3; f++)
+        {
+            sums[c * 3 + f] += data.row(i)[f];
+        }
+    }
+    for (size_t k = 0; k < 12; k++)
+    {
+        EXPECT_NEAR(sums[k] / counts[k / 3], blobs.getCenters()[k], 0.1);
+    }
+
+    Dataset cls = Generators::make_classification(4000, 10, 3, 2.0, 0.0, 5);
+    EXPECT_EQ(cls.feature_dim(), 10);
+    double informative = 0.0, noise = 0.0;
+    for (size_t i = 0; i < cls.size(); i++)
+    {
+        ASSERT_TRUE(cls.label(i) == 1.0 || cls.label(i) == -1.0);
+        informative += std::abs(cls.row(i)[0]);
+        noise += cls.row(i)[9];
+    }
+    EXPECT_GT(informative / cls.size(), 1.5);
+    EXPECT_NEAR(noise / cls.size(), 0.0, 0.1);
+    EXPECT_THROW(ClassificationGenerator(5, 6), std::invalid_argument);
+}
+
+TEST_F(GeneratorsTest, WritesCsvAndBinary)
+{
+    BlobsGenerator blobs(3, 2, 1.0, 10.0, 4);
+    Dataset expected = Generators::generate(blobs, 150000);
+
+    // More rows than one block, so the file is written in several pieces
+    Generators::write_binary(blobs, 150000, path, BinaryDataset::DType::F64, 2);
+    expect_same(expected, BinaryDataset::load(path, true));
+
+    DatasetSchema schema;
+    schema.label_type = LabelType::Multiclass;
+    Generators::write_csv(blobs, 1000, path, 3);
+    Dataset csv = DataLoader::load_dataset(path, schema);
+    ASSERT_EQ(csv.size(), 1000);
+    for (size_t i = 0; i < csv.size(); i++)
+    {
+        ASSERT_EQ(csv.row_vector(i), expected.row_vector(i));
+        ASSERT_EQ(csv.getClasses()[static_cast<size_t>(csv.label(i))], expected.getClasses()[static_cast<size_t>(expected.label(i))]);
+    }
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "data/BatchLoader.hpp"
+#include "data/DatasetStream.hpp"
+#include "data/Normalizer.hpp"
+
+class NormalizerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = (std::filesystem::temp_directory_path() / "agrad_normalizer_test.csv").string();
+        stats_path = (std::filesystem::temp_directory_path() / "agrad_normalizer_test.nrm").string();
+
+        // Features on very different scales, far from zero
+        std::mt19937_64 rng(7);
+        std::normal_distribution<double> a(1000.0, 50.0);
+        std::uniform_real_distribution<double> b(-0.01, 0.03);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.precision(17);
+        out << "a,b,label\n";
+        for (int i = 0; i < rows; i++)
+        {
+            out << a(rng) << "," << b(rng) << "," << (i % 2 ? 1 : -1) << "\n";
+        }
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+        std::filesystem::remove(stats_path);
+    }
+
+    static constexpr int rows = 5000;
+    std::string path;
+    std::string stats_path;
+    DatasetSchema schema{{}, "label", LabelType::Binary, ','};
+};
+
+TEST_F(NormalizerTest, StatsMatchTwoPass)
+{
+    Dataset dataset = DataLoader::load_dataset(path, schema, 1);
+    FeatureStats stats = FeatureStats::of(dataset);
+    ASSERT_EQ(stats.getCount(), rows);
+
+    for (size_t f = 0; f < 2; f++)
+    {
+        double sum = 0.0, lo = INFINITY, hi = -INFINITY;
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            sum += dataset.row(i)[f];
+            lo = std::min(lo, dataset.row(i)[f]);
+            hi = std::max(hi, dataset.row(i)[f]);
+        }
+        const double mean = sum / rows;
+        double squares = 0.0;
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            squares += (dataset.row(i)[f] - mean) * (dataset.row(i)[f] - mean);
+        }
+        EXPECT_NEAR(stats.mean(f), mean, 1e-12 * std::abs(mean));
+        EXPECT_NEAR(stats.variance(f), squares / rows, 1e-9 * squares / rows);
+        EXPECT_EQ(stats.min(f), lo);
+        EXPECT_EQ(stats.max(f), hi);
+    }
+
+    // Merging the statistics of two halves gives those of the whole
+    FeatureStats merged = FeatureStats::of(dataset.slice(0, 1234));
+    merged.merge(FeatureStats::of(dataset.slice(1234, rows)));
+    EXPECT_EQ(merged.getCount(), rows);
+    for (size_t f = 0; f < 2; f++)
+    {
+        EXPECT_NEAR(merged.mean(f), stats.mean(f), 1e-12 * std::abs(stats.mean(f)));
+        EXPECT_NEAR(merged.variance(f), stats.variance(f), 1e-9 * stats.variance(f));
+        EXPECT_EQ(merged.min(f), stats.min(f));
+        EXPECT_EQ(merged.max(f), stats.max(f));
+    }
+}
+
+TEST_F(NormalizerTest, FusedIntoLoading)
+{
+    Dataset raw = DataLoader::load_dataset(path, schema, 1);
+    const FeatureStats expected = FeatureStats::of(raw);
+
+    for (size_t threads : {1, 4})
+    {
+        FeatureStats stats;
+        DataLoader::load_dataset(path, schema, threads, &stats);
+        ASSERT_EQ(stats.getCount(), rows);
+        for (size_t f = 0; f < 2; f++)
+        {
+            EXPECT_NEAR(stats.mean(f), expected.mean(f), 1e-12 * std::abs(expected.mean(f)));
+            EXPECT_NEAR(stats.variance(f), expected.variance(f), 1e-9 * expected.variance(f));
+        }
+    }
+
+    // Normalizing while parsing matches normalizing the loaded dataset in place
+    const Normalizer normalizer(expected);
+    Dataset fused = DataLoader::load_dataset(path, schema, 4, nullptr, &normalizer);
+    normalizer.apply(raw);
+    ASSERT_EQ(fused.size(), raw.size());
+    for (size_t i = 0; i < raw.size(); i++)
+    {
+        EXPECT_DOUBLE_EQ(fused.row(i)[0], raw.row(i)[0]);
+        EXPECT_DOUBLE_EQ(fused.row(i)[1], raw.row(i)[1]);
+        EXPECT_EQ(fused.label(i), raw.label(i));
+    }
+
+    const FeatureStats normalized = FeatureStats::of(fused);
+    for (size_t f = 0; f < 2; f++)
+    {
+        EXPECT_NEAR(normalized.mean(f), 0.0, 1e-9);
+        EXPECT_NEAR(normalized.variance(f), 1.0, 1e-9);
+    }
+
+    const Normalizer wrong(FeatureStats(3));
+    EXPECT_THROW(DataLoader::load_dataset(path, schema, 1, nullptr, &wrong), std::invalid_argument);
+}
+
+TEST_F(NormalizerTest, MinMaxAndConstantFeatures)
+{
+    Dataset dataset(3, 2);
+    const double values[3][2] = {{2.0, 5.0}, {4.0, 5.0}, {10.0, 5.0}};
+    for (size_t i = 0; i < 3; i++)
+    {
+        dataset.row(i)[0] = values[i][0];
+        dataset.row(i)[1] = values[i][1];
+    }
+
+    const Normalizer normalizer(FeatureStats::of(dataset), NormalizeMode::MinMax);
+    EXPECT_EQ(normalizer.transform({2.0, 5.0}), (std::vector<double>{0.0, 0.0}));
+    EXPECT_EQ(normalizer.transform({10.0, 5.0}), (std::vector<double>{1.0, 0.0}));
+    EXPECT_EQ(normalizer.transform({4.0, 7.0}), (std::vector<double>{0.25, 2.0}));
+    EXPECT_THROW(normalizer.transform({1.0}), std::invalid_argument);
+
+    std::vector<double> x = normalizer.transform({6.0, 3.0});
+    normalizer.invert(x.data());
+    EXPECT_EQ(x, (std::vector<double>{6.0, 3.0}));
+}
+
+TEST_F(NormalizerTest, SaveLoad)
+{
+    FeatureStats stats;
+    DataLoader::load_dataset(path, schema, 1, &stats);
+    const Normalizer normalizer(stats);
+    normalizer.save(stats_path);
+
+    const Normalizer loaded = Normalizer::load(stats_path);
+    EXPECT_EQ(loaded.getMode(), NormalizeMode::Standard);
+    EXPECT_EQ(loaded.getStats().getCount(), rows);
+    ASSERT_EQ(loaded.feature_dim(), 2);
+    for (size_t f = 0; f < 2; f++)
+    {
+        EXPECT_EQ(loaded.getOffset(f), normalizer.getOffset(f));
+        EXPECT_EQ(loaded.getScale(f), normalizer.getScale(f));
+        EXPECT_EQ(loaded.getStats().min(f), stats.min(f));
+        EXPECT_EQ(loaded.getStats().max(f), stats.max(f));
+    }
+
+    std::filesystem::resize_file(stats_path, std::filesystem::file_size(stats_path) - 8);
+    try
+    {
+        Normalizer::load(stats_path);
+        FAIL() << "expected an error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Invalid normalizer " + stats_path + ": size does not match the header");
+    }
+
+    {
+        std::ofstream out(stats_path, std::ios::binary | std::ios::trunc);
+        out << "not a normalizer file at all, just text";
+    }
+    try
+    {
+        Normalizer::load(stats_path);
+        FAIL() << "expected an error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Invalid normalizer " + stats_path + ": bad magic");
+    }
+}
+
+TEST_F(NormalizerTest, StreamAndBatchLoader)
+{
+    FeatureStats expected;
+    Dataset raw = DataLoader::load_dataset(path, schema, 1, &expected);
+
+    // The stream has the statistics once its first epoch is over
+    StreamOptions options;
+    options.batch_size = 64;
+    options.chunk_bytes = 1024;
+    options.drop_last = true;
+    DatasetStream stream(path, schema, options);
+    EXPECT_FALSE(stream.hasStats());
+    for (const Dataset &batch : stream)
+    {
+        (void)batch;
+    }
+    ASSERT_TRUE(stream.hasStats());
+    EXPECT_EQ(stream.getStats().getCount(), rows);
+    EXPECT_NEAR(stream.getStats().mean(0), expected.mean(0), 1e-12 * std::abs(expected.mean(0)));
+    EXPECT_NEAR(stream.getStats().variance(1), expected.variance(1), 1e-9 * expected.variance(1));
+
+    // Both loaders hand out normalized rows and leave the source untouched
+    const Normalizer normalizer(stream.getStats());
+    options.normalizer = &normalizer;
+    DatasetStream normalized(path, schema, options);
+    Dataset batch;
+    ASSERT_TRUE(normalized.next(batch));
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        EXPECT_NEAR(batch.row(i)[0], normalizer.transform(raw.row_vector(i))[0], 1e-12);
+    }
+
+    BatchLoaderOptions loader_options;
+    loader_options.batch_size = 64;
+    loader_options.shuffle = false;
+    loader_options.normalizer = &normalizer;
+    BatchLoader loader(raw, loader_options);
+    const MiniBatch *first = loader.next();
+    ASSERT_NE(first, nullptr);
+    for (size_t i = 0; i < first->size(); i++)
+    {
+        EXPECT_EQ(first->x[i], normalizer.transform(raw.row_vector(i)));
+    }
+    EXPECT_EQ(loader.getDataset().row(0)[0], raw.row(0)[0]);
+
+    const Normalizer wrong(FeatureStats(3));
+    loader_options.normalizer = &wrong;
+    EXPECT_THROW(BatchLoader(raw, loader_options), std::invalid_argument);
+}
@@ -1,107 +1,92 @@
+#include "agrad/Loss.hpp"
+#include "agrad/Trace.hpp"
 #include "agrad/Value.hpp"
 #include "data/DataLoader.hpp"
 #include "nn/MLP.hpp"
+#include "nn/MapRenderer.hpp"
+#include "nn/QuantizedMLP.hpp"
+#include "nn/Trainer.hpp"
 #include "nn/Visualization.hpp"
 
 int main()
 {
+    // AGRAD_TRACE=<file> records a Chrome trace of loading and training
+    const char *trace_path = std::getenv("AGRAD_TRACE");
+    if (trace_path)
+    {
+        agrad::trace::start();
+    }
+
     // Load the dataset
     auto dataset = DataLoader::load_dataset("../data/moon_dataset.csv");
 
     // Split the dataset into training and validation sets
-    auto [train_dataset, val_dataset] = DataLoader::train_test_split(dataset, 1.0, 0);
+    auto [train_dataset, val_dataset] = DataLoader::train_test_split(dataset, 0.8, 0);
 
-    std::cout << "Train dataset size: " << train_dataset.X.size() << std::endl;
-    std::cout << "Validation dataset size: " << val_dataset.X.size() << std::endl;
+    std::cout << "Train dataset size: " << train_dataset.size() << std::endl;
+    std::cout << "Validation dataset size: " << val_dataset.size() << std::endl;
 
     MLP model(2, {16, 16, 1}, false);
 
     int EPOCHS = 500;
-    double LEARNING_RATE = 0.001;
-    int BATCH_SIZE = 1;
-    double epoch_loss = 0.0;
-    double epoch_val_loss = 0.0;
-    double accuracy = 0.0;
-    int training_batches = train_dataset.X.size() / BATCH_SIZE;
-    int validation_batches = val_dataset.X.size() / BATCH_SIZE;
+    TrainerConfig config;
+    config.learning_rate = 0.001;
+    config.batch_size = 1;
+    config.telemetry_path = "telemetry.jsonl"; // per-step phase timings and graph sizes
+    Trainer trainer(model, config);
+
+    // Reshuffled every epoch; a worker thread prepares batches while the model trains
+    BatchLoaderOptions loader_options;
+    loader_options.batch_size = config.batch_size;
+    loader_options.seed = 42;
+    BatchLoader loader(train_dataset, loader_options);
+
+    // AGRAD_MAPS=<dir> writes a decision map PNG every 50 epochs on a background thread
+    const char *maps_dir = std::getenv("AGRAD_MAPS");
+    std::future<void> map_written;
 
     for (int i = 0; i < EPOCHS; i++)
     {
-        epoch_loss = 0.0;
-        epoch_val_loss = 0.0;
-        accuracy = 0.0;
-
-        for (int j = 0; j < training_batches; j++)
-        {
-            std::vector<std::vector<double>> batch_samples_x(train_dataset.X.begin() + (j * BATCH_SIZE), train_dataset.X.begin() + (j * BATCH_SIZE) + BATCH_SIZE);
-            std::vector<double> batch_samples_y(train_dataset.y.begin() + (j * BATCH_SIZE), train_dataset.y.begin() + (j * BATCH_SIZE) + BATCH_SIZE);
-
-            // Forward pass
-            auto y_pred = model(batch_samples_x);
-
-            // Compute loss and accuracy
-            Value::ValuePtr loss = Value::create(0.0);
-
-            for (size_t z = 0; z < BATCH_SIZE; z++)
-            {
-                loss = loss + (y_pred[z] - Value::create(batch_samples_y[z]))->pow(2);
-                accuracy += (y_pred[z]->getData() > 0.5) == (batch_samples_y[z] == 1);
-            }
-
-            // Backward pass
-            model.zero_grad();
-            loss->backward();
-            epoch_loss += loss->getData();
-
-            // Update parameters
-            for (auto &param : model.parameters())
-            {
-                param->setData(param->getData() - LEARNING_RATE * param->getGrad());
-            }
-        }
-
-        // Validation
-        for (int j = 0; j < validation_batches; j++)
+        auto train = trainer.train_epoch(loader);
+        auto val = trainer.evaluate(val_dataset);
+        if (maps_dir && i % 50 == 0)
         {
-            std::vector<sample> batch_samples;
-            for (int z = 0; z < BATCH_SIZE; z++)
+            if (map_written.valid())
             {
-                batch_samples.push_back({val_dataset.X[j * BATCH_SIZE + z], val_dataset.y[j * BATCH_SIZE + z]});
+                map_written.get();
             }
-
-            // Forward pass
-            std::vector<Value::ValuePtr> y_pred;
-            for (auto &sample : batch_samples)
-            {
-                y_pred.push_back(model(sample.x)[0]);
-            }
-
-            // Compute loss
-            Value::ValuePtr loss = Value::create(0.0);
-
-            for (size_t z = 0; z < BATCH_SIZE; z++)
-            {
-                loss = loss + (y_pred[z] - Value::create(batch_samples[z].y))->pow(2);
-                accuracy += (y_pred[z]->getData() > 0.5) == (batch_samples[z].y == 1);
-            }
-
-            epoch_val_loss += loss->getData();
+            const std::string file = std::string(maps_dir) + "/epoch_" + std::to_string(i) + ".png";
+            map_written = MapRenderer::write_async(model.freeze(), DecisionGrid::around(dataset, 1200, 900), dataset, file);
         }
 
-        epoch_loss /= training_batches;
-        epoch_val_loss /= validation_batches;
-        accuracy = (accuracy / dataset.X.size()) * 100.0;
-
-        std::cout << "Epoch[" << i << "]: " << epoch_loss << ", Val: " << epoch_val_loss << ", Acc: " << accuracy << "%" << std::endl;
+        std::cout << "Epoch[" << i << "]: " << train.loss << ", Val: " << val.loss << ", Acc: " << train.accuracy << "%"
+                  << ", Val Acc: " << val.accuracy << "%, " << static_cast<long>(train.samples_per_sec) << " samples/s" << std::endl;
+    }
+    if (map_written.valid())
+    {
+        map_written.get();
+    }
+    trainer.flush_telemetry();
+    if (trace_path)
+    {
+        agrad::trace::stop();
+        std::cout << "Wrote " << agrad::trace::write(trace_path) << " trace events to " << trace_path << std::endl;
     }
 
-    // Visualize the decision boundary
-    auto predict_fn = [&model](double x1, double x2) -> int
+    if (agrad::profiler::enabled())
     {
-        return model({x1, x2})[0]->getData() > 0;
-    };
+        agrad::profiler::print();
+    }
+
+    auto frozen = model.freeze();
+
+    // Int8 model calibrated on the training split, checked on the held-out split
+    auto quantized = QuantizedMLP::quantize(frozen, train_dataset);
+    std::cout << QuantizedMLP::compare(frozen, quantized, val_dataset);
 
-    DatasetVisualizer::visualize_with_decision_boundary(dataset, predict_fn);
+    // Visualize the decision boundary; the 1000x1000 grid is only evaluated densely near it
+    auto map = DecisionMap::adaptive(frozen, DecisionGrid::around(dataset, 1000, 1000));
+    DatasetVisualizer::visualize_with_decision_boundary(dataset, map);
 
     return 0;
 }
\ No newline at end of file
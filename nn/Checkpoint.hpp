@@ -0,0 +1,226 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "data/ByteOrder.hpp"
+#include "data/MappedFile.hpp"
+#include "nn/InferenceMLP.hpp"
+
+// Versioned binary checkpoint of an MLP's weights. All fields are little-endian:
+//
+//   offset  0  char[8]  magic "AGRADMLP"
+//           8  u32      format version
+//          12  u32      dtype (0 = f64, 1 = f32)
+//          16  u32      number of layers
+//          20  u32      reserved
+//          24  u64      blob offset (multiple of 64)
+//          32  u64      blob size in bytes
+//          40  per layer: u32 inputs, u32 outputs, u32 flags (bit 0 nonlin, bit 1 relu), u32 reserved
+//
+// followed by zero padding and the blob: every layer's weights (outputs x inputs,
+// row-major) back to back, then every layer's biases. This is exactly the layout of
+// InferenceMLP, so a mapped file can be used in place.
+class Checkpoint
+{
+public:
+    static constexpr uint32_t version = 1;
+    static constexpr size_t blob_alignment = 64;
+
+private:
+    Checkpoint() = delete;
+
+    static constexpr char magic[8] = {'A', 'G', 'R', 'A', 'D', 'M', 'L', 'P'};
+    static constexpr size_t header_size = 40;
+    static constexpr size_t layer_record_size = 16;
+    static constexpr uint32_t flag_nonlin = 1;
+    static constexpr uint32_t flag_relu = 2;
+
+    enum DType : uint32_t
+    {
+        F64 = 0,
+        F32 = 1,
+    };
+
+    struct Header
+    {
+        uint32_t dtype;
+        uint64_t blob_offset;
+        uint64_t blob_size;
+        std::vector<InferenceMLP<>::LayerSpec> layers;
+        size_t weight_count = 0;
+        size_t bias_count = 0;
+    };
+
+    template <typename T>
+    static constexpr uint32_t dtype_of()
+    {
+        return std::is_same<T, double>::value ? F64 : F32;
+    }
+
+    static size_t dtype_size(uint32_t dtype)
+    {
+        return dtype == F64 ? sizeof(double) : sizeof(float);
+    }
+
+    static Header parse_header(const char *data, size_t size, const std::string &filename)
+    {
+        auto invalid = [&](const std::string &reason)
+        {
+            return std::runtime_error("Invalid checkpoint " + filename + ": " + reason);
+        };
+
+        if (size < header_size || std::memcmp(data, magic, sizeof(magic)) != 0)
+        {
+            throw invalid("bad magic");
+        }
+        if (byte_order::read_le<uint32_t>(data + 8) != version)
+        {
+            throw invalid("unsupported version " + std::to_string(byte_order::read_le<uint32_t>(data + 8)));
+        }
+
+        Header h;
+        h.dtype = byte_order::read_le<uint32_t>(data + 12);
+        if (h.dtype != F64 && h.dtype != F32)
+        {
+            throw invalid("unknown dtype");
+        }
+
+        uint32_t num_layers = byte_order::read_le<uint32_t>(data + 16);
+        h.blob_offset = byte_order::read_le<uint64_t>(data + 24);
+        h.blob_size = byte_order::read_le<uint64_t>(data + 32);
+        if (num_layers == 0 || header_size + num_layers * layer_record_size > size)
+        {
+            throw invalid("truncated header");
+        }
+
+        for (uint32_t i = 0; i < num_layers; i++)
+        {
+            const char *record = data + header_size + i * layer_record_size;
+            uint32_t flags = byte_order::read_le<uint32_t>(record + 8);
+            InferenceMLP<>::LayerSpec spec;
+            spec.inputs = static_cast<int>(byte_order::read_le<uint32_t>(record));
+            spec.outputs = static_cast<int>(byte_order::read_le<uint32_t>(record + 4));
+            spec.nonlin = flags & flag_nonlin;
+            spec.relu = flags & flag_relu;
+            h.weight_count += static_cast<size_t>(spec.inputs) * spec.outputs;
+            h.bias_count += spec.outputs;
+            h.layers.push_back(spec);
+        }
+
+        if (h.blob_offset % blob_alignment != 0 ||
+            h.blob_size != (h.weight_count + h.bias_count) * dtype_size(h.dtype) ||
+            h.blob_offset < header_size + num_layers * layer_record_size ||
+            h.blob_offset + h.blob_size > size)
+        {
+            throw invalid("blob does not match layer dimensions");
+        }
+
+        return h;
+    }
+
+    template <typename T, typename Stored>
+    static std::vector<T> copy_blob(const char *p, size_t count)
+    {
+        std::vector<T> values(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values[i] = static_cast<T>(byte_order::read_le<Stored>(p + i * sizeof(Stored)));
+        }
+        return values;
+    }
+
+public:
+    template <typename T>
+    static void save(const InferenceMLP<T> &model, const std::string &filename)
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        const auto &layers = model.getLayers();
+        const size_t records_end = header_size + layers.size() * layer_record_size;
+        const uint64_t blob_offset = (records_end + blob_alignment - 1) / blob_alignment * blob_alignment;
+        const uint64_t blob_size = (model.getWeightCount() + model.getBiasCount()) * sizeof(T);
+
+        out.write(magic, sizeof(magic));
+        byte_order::write_le<uint32_t>(out, version);
+        byte_order::write_le<uint32_t>(out, dtype_of<T>());
+        byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(layers.size()));
+        byte_order::write_le<uint32_t>(out, 0);
+        byte_order::write_le<uint64_t>(out, blob_offset);
+        byte_order::write_le<uint64_t>(out, blob_size);
+
+        for (const auto &l : layers)
+        {
+            byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(l.inputs));
+            byte_order::write_le<uint32_t>(out, static_cast<uint32_t>(l.outputs));
+            byte_order::write_le<uint32_t>(out, (l.nonlin ? flag_nonlin : 0) | (l.relu ? flag_relu : 0));
+            byte_order::write_le<uint32_t>(out, 0);
+        }
+
+        const std::string padding(blob_offset - records_end, '\0');
+        out.write(padding.data(), padding.size());
+
+        // InferenceMLP keeps all weights and all biases in two contiguous arrays
+        if (byte_order::host_little_endian())
+        {
+            out.write(reinterpret_cast<const char *>(model.getWeights(0)), model.getWeightCount() * sizeof(T));
+            out.write(reinterpret_cast<const char *>(model.getBiases(0)), model.getBiasCount() * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i < model.getWeightCount(); i++)
+            {
+                byte_order::write_le<T>(out, model.getWeights(0)[i]);
+            }
+            for (size_t i = 0; i < model.getBiasCount(); i++)
+            {
+                byte_order::write_le<T>(out, model.getBiases(0)[i]);
+            }
+        }
+
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing checkpoint: " + filename);
+        }
+    }
+
+    // Map the checkpoint and build a model on top of it. When the stored dtype matches T the
+    // weights are used in place, so loading costs one mmap plus the page faults on first use;
+    // otherwise they are converted into owned memory.
+    template <typename T = double>
+    static InferenceMLP<T> load(const std::string &filename)
+    {
+        auto file = std::make_shared<const MappedFile>(filename);
+        Header h = parse_header(file->data(), file->size(), filename);
+
+        std::vector<typename InferenceMLP<T>::LayerSpec> specs;
+        for (const auto &l : h.layers)
+        {
+            specs.push_back({l.inputs, l.outputs, l.nonlin, l.relu});
+        }
+
+        const char *blob = file->data() + h.blob_offset;
+        if (h.dtype == dtype_of<T>() && byte_order::host_little_endian())
+        {
+            const T *weights = reinterpret_cast<const T *>(blob);
+            return InferenceMLP<T>(std::move(specs), weights, weights + h.weight_count, std::move(file));
+        }
+
+        const size_t stored = dtype_size(h.dtype);
+        const char *bias_blob = blob + h.weight_count * stored;
+        if (h.dtype == F64)
+        {
+            return InferenceMLP<T>(std::move(specs), copy_blob<T, double>(blob, h.weight_count), copy_blob<T, double>(bias_blob, h.bias_count));
+        }
+        return InferenceMLP<T>(std::move(specs), copy_blob<T, float>(blob, h.weight_count), copy_blob<T, float>(bias_blob, h.bias_count));
+    }
+};
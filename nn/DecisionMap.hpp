@@ -0,0 +1,350 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "agrad/Parallel.hpp"
+#include "agrad/Trace.hpp"
+#include "data/Dataset.hpp"
+#include "data/Normalizer.hpp"
+
+// Regular grid over the plane of two features; point (i, j) is (x(j), y(i))
+struct DecisionGrid
+{
+    double x_min = 0.0;
+    double y_min = 0.0;
+    double dx = 1.0;
+    double dy = 1.0;
+    size_t nx = 0;
+    size_t ny = 0;
+
+    double x(size_t j) const { return x_min + dx * static_cast<double>(j); }
+    double y(size_t i) const { return y_min + dy * static_cast<double>(i); }
+    size_t size() const { return nx * ny; }
+
+    // x_min, x_min + h, ... up to but excluding x_max, and the same for y
+    static DecisionGrid with_step(double x_min, double x_max, double y_min, double y_max, double h)
+    {
+        if (!(h > 0.0) || !(x_max > x_min) || !(y_max > y_min))
+        {
+            throw std::invalid_argument("Grid step and ranges must be positive");
+        }
+        DecisionGrid grid;
+        grid.x_min = x_min;
+        grid.y_min = y_min;
+        grid.dx = grid.dy = h;
+        grid.nx = static_cast<size_t>(std::ceil((x_max - x_min) / h));
+        grid.ny = static_cast<size_t>(std::ceil((y_max - y_min) / h));
+        return grid;
+    }
+
+    // nx by ny points spanning both ranges, ends included
+    static DecisionGrid with_size(double x_min, double x_max, double y_min, double y_max, size_t nx, size_t ny)
+    {
+        if (nx < 2 || ny < 2 || !(x_max > x_min) || !(y_max > y_min))
+        {
+            throw std::invalid_argument("Grid needs at least 2 points and a positive range on each axis");
+        }
+        DecisionGrid grid;
+        grid.x_min = x_min;
+        grid.y_min = y_min;
+        grid.dx = (x_max - x_min) / static_cast<double>(nx - 1);
+        grid.dy = (y_max - y_min) / static_cast<double>(ny - 1);
+        grid.nx = nx;
+        grid.ny = ny;
+        return grid;
+    }
+
+    // nx by ny points over the first two features of dataset, widened by margin on each side
+    static DecisionGrid around(const Dataset &dataset, size_t nx, size_t ny, double margin = 1.0)
+    {
+        if (dataset.empty() || dataset.feature_dim() < 2)
+        {
+            throw std::invalid_argument("Grid needs a non-empty dataset with 2 features");
+        }
+        double x_lo = dataset.row(0)[0], x_hi = x_lo;
+        double y_lo = dataset.row(0)[1], y_hi = y_lo;
+        for (size_t i = 1; i < dataset.size(); i++)
+        {
+            const double *x = dataset.row(i);
+            x_lo = std::min(x_lo, x[0]);
+            x_hi = std::max(x_hi, x[0]);
+            y_lo = std::min(y_lo, x[1]);
+            y_hi = std::max(y_hi, x[1]);
+        }
+        return with_size(x_lo - margin, x_hi + margin, y_lo - margin, y_hi + margin, nx, ny);
+    }
+};
+
+// Model outputs over every point of a DecisionGrid in one flat row-major buffer (grid rows,
+// then columns, then outputs). It never builds a graph: it takes a frozen model (InferenceMLP
+// or QuantizedMLP), generates grid points a tile at a time and runs each tile through the
+// batched predict(), with the work split into bands over several threads.
+//
+// evaluate() runs the model on every point. adaptive() runs it on a coarse lattice and only
+// subdivides the cells whose corners disagree in class, which on a typical map is a small
+// fraction of the points; see there.
+class DecisionMap
+{
+public:
+    // Points generated and predicted together; 2 x 1024 coordinates stay in L1
+    static constexpr size_t tile_points = 1024;
+
+private:
+    DecisionGrid grid;
+    size_t outputs = 0;
+    std::vector<double> scores;
+    size_t evaluations = 0;
+
+    template <typename Model>
+    static void check(const Model &model, const Normalizer *normalizer)
+    {
+        if (model.getInputs() != 2)
+        {
+            throw std::invalid_argument("Decision map needs a model with 2 inputs");
+        }
+        if (normalizer && normalizer->feature_dim() != 2)
+        {
+            throw std::invalid_argument("Feature size mismatch");
+        }
+    }
+
+    // Runs fn(begin, end) over tile-aligned bands of [0, n), one band per thread, so no two
+    // threads write the same tile. threads = 0 picks one per core.
+    template <typename F>
+    static void split_tiles(size_t n, size_t threads, const F &fn)
+    {
+        agrad::parallel_ranges(n, threads, tile_points, [&](size_t, size_t begin, size_t end)
+                               { fn(begin, end); });
+    }
+
+    // Evaluates the grid points with the given flat indices, scattering their scores
+    template <typename Model>
+    void evaluate_points(const Model &model, const std::vector<size_t> &points, size_t threads, const Normalizer *normalizer)
+    {
+        split_tiles(points.size(), threads, [&](size_t begin, size_t end)
+                    {
+            double coords[2 * tile_points];
+            std::vector<double> out(tile_points * outputs);
+            for (size_t p0 = begin; p0 < end; p0 += tile_points)
+            {
+                const size_t count = std::min(tile_points, end - p0);
+                for (size_t k = 0; k < count; k++)
+                {
+                    coords[2 * k] = grid.x(points[p0 + k] % grid.nx);
+                    coords[2 * k + 1] = grid.y(points[p0 + k] / grid.nx);
+                    if (normalizer)
+                    {
+                        normalizer->apply(coords + 2 * k);
+                    }
+                }
+                model.predict(coords, count, out.data());
+                for (size_t k = 0; k < count; k++)
+                {
+                    std::copy(out.data() + k * outputs, out.data() + (k + 1) * outputs, scores.data() + points[p0 + k] * outputs);
+                }
+            } });
+        evaluations += points.size();
+    }
+
+    int label_at(size_t p) const
+    {
+        const double *s = scores.data() + p * outputs;
+        if (outputs == 1)
+        {
+            return s[0] > 0.0 ? 1 : -1;
+        }
+        return static_cast<int>(std::max_element(s, s + outputs) - s);
+    }
+
+public:
+    DecisionMap() = default;
+    DecisionMap(const DecisionGrid &grid, size_t outputs)
+        : grid(grid), outputs(outputs), scores(grid.size() * outputs) {}
+
+    // Runs the model on every grid point. normalizer, if given, maps grid points to the units
+    // the model was trained in.
+    template <typename Model>
+    static DecisionMap evaluate(const Model &model, const DecisionGrid &grid, size_t threads = 0,
+                                const Normalizer *normalizer = nullptr)
+    {
+        agrad::trace::Scope span("decision_map", "nn", static_cast<int64_t>(grid.size()));
+        check(model, normalizer);
+
+        DecisionMap map(grid, model.getOutputs());
+        split_tiles(grid.size(), threads, [&](size_t begin, size_t end)
+                    {
+            double points[2 * tile_points];
+            size_t i = begin / grid.nx;
+            size_t j = begin % grid.nx;
+            for (size_t p0 = begin; p0 < end; p0 += tile_points)
+            {
+                const size_t count = std::min(tile_points, end - p0);
+                for (size_t k = 0; k < count; k++)
+                {
+                    points[2 * k] = grid.x(j);
+                    points[2 * k + 1] = grid.y(i);
+                    if (normalizer)
+                    {
+                        normalizer->apply(points + 2 * k);
+                    }
+                    if (++j == grid.nx)
+                    {
+                        j = 0;
+                        i++;
+                    }
+                }
+                model.predict(points, count, map.scores.data() + p0 * map.outputs);
+            } });
+        map.evaluations = grid.size();
+        return map;
+    }
+
+    // Runs the model on a lattice of every cell-th grid point, then repeatedly splits the
+    // cells whose four corners disagree in class into quarters, evaluating only the new
+    // corners; each level is one batched, threaded pass. Points inside a cell whose corners
+    // agree get the bilinear interpolation of the corner scores, which keeps their class, so
+    // label() matches evaluate() everywhere except for class regions that fit inside a
+    // lattice cell without touching a corner. cell trades how small such a region can be
+    // against how many points the first level costs.
+    template <typename Model>
+    static DecisionMap adaptive(const Model &model, const DecisionGrid &grid, size_t cell = 16, size_t threads = 0,
+                                const Normalizer *normalizer = nullptr)
+    {
+        agrad::trace::Scope span("decision_map_adaptive", "nn", static_cast<int64_t>(grid.size()));
+        check(model, normalizer);
+        if (cell == 0)
+        {
+            throw std::invalid_argument("Cell size must be positive");
+        }
+
+        DecisionMap map(grid, model.getOutputs());
+        if (grid.size() == 0)
+        {
+            return map;
+        }
+        // Points whose scores come from the model; the others are interpolated
+        std::vector<uint8_t> evaluated(grid.size(), 0);
+        std::vector<size_t> pending;
+        auto request = [&](size_t i, size_t j)
+        {
+            const size_t p = i * grid.nx + j;
+            if (!evaluated[p])
+            {
+                evaluated[p] = 1;
+                pending.push_back(p);
+            }
+        };
+
+        struct Cell
+        {
+            size_t i0, i1, j0, j1;
+        };
+        std::vector<Cell> cells;
+        for (size_t i0 = 0; i0 + 1 < std::max<size_t>(grid.ny, 2); i0 += cell)
+        {
+            const size_t i1 = std::min(i0 + cell, grid.ny - 1);
+            for (size_t j0 = 0; j0 + 1 < std::max<size_t>(grid.nx, 2); j0 += cell)
+            {
+                const size_t j1 = std::min(j0 + cell, grid.nx - 1);
+                cells.push_back({i0, i1, j0, j1});
+                request(i0, j0);
+                request(i0, j1);
+                request(i1, j0);
+                request(i1, j1);
+            }
+        }
+
+        std::vector<Cell> next;
+        while (!cells.empty())
+        {
+            map.evaluate_points(model, pending, threads, normalizer);
+            pending.clear();
+            next.clear();
+
+            for (const Cell &c : cells)
+            {
+                if (c.i1 - c.i0 <= 1 && c.j1 - c.j0 <= 1)
+                {
+                    continue; // every point is a corner
+                }
+                const size_t corners[4] = {c.i0 * grid.nx + c.j0, c.i0 * grid.nx + c.j1, c.i1 * grid.nx + c.j0, c.i1 * grid.nx + c.j1};
+                const int label = map.label_at(corners[0]);
+                if (map.label_at(corners[1]) == label && map.label_at(corners[2]) == label && map.label_at(corners[3]) == label)
+                {
+                    map.interpolate(c.i0, c.i1, c.j0, c.j1, evaluated);
+                    continue;
+                }
+
+                // Halve each side longer than one step
+                const bool split_rows = c.i1 - c.i0 > 1;
+                const bool split_cols = c.j1 - c.j0 > 1;
+                const size_t im = (c.i0 + c.i1) / 2;
+                const size_t jm = (c.j0 + c.j1) / 2;
+                const std::pair<size_t, size_t> rows[2] = {{c.i0, split_rows ? im : c.i1}, {im, c.i1}};
+                const std::pair<size_t, size_t> cols[2] = {{c.j0, split_cols ? jm : c.j1}, {jm, c.j1}};
+                for (size_t a = 0; a < (split_rows ? 2 : 1); a++)
+                {
+                    for (size_t b = 0; b < (split_cols ? 2 : 1); b++)
+                    {
+                        const auto [i0, i1] = rows[a];
+                        const auto [j0, j1] = cols[b];
+                        request(i0, j0);
+                        request(i0, j1);
+                        request(i1, j0);
+                        request(i1, j1);
+                        next.push_back({i0, i1, j0, j1});
+                    }
+                }
+            }
+            cells.swap(next);
+        }
+        return map;
+    }
+
+    const DecisionGrid &getGrid() const { return grid; }
+    size_t getOutputs() const { return outputs; }
+    const double *data() const { return scores.data(); }
+    // Grid points the model was run on
+    size_t getEvaluations() const { return evaluations; }
+
+    double score(size_t i, size_t j, size_t output = 0) const
+    {
+        return scores[(i * grid.nx + j) * outputs + output];
+    }
+
+    // Predicted class at point (i, j): +1 or -1 for a single output, otherwise the index of
+    // the largest output
+    int label(size_t i, size_t j) const { return label_at(i * grid.nx + j); }
+
+private:
+    // Bilinear interpolation of the corner scores over the points of a cell that were not
+    // evaluated. A later, finer cell sharing an edge overwrites it with a closer estimate.
+    void interpolate(size_t i0, size_t i1, size_t j0, size_t j1, const std::vector<uint8_t> &evaluated)
+    {
+        const double *c00 = scores.data() + (i0 * grid.nx + j0) * outputs;
+        const double *c01 = scores.data() + (i0 * grid.nx + j1) * outputs;
+        const double *c10 = scores.data() + (i1 * grid.nx + j0) * outputs;
+        const double *c11 = scores.data() + (i1 * grid.nx + j1) * outputs;
+        for (size_t i = i0; i <= i1; i++)
+        {
+            const double u = i1 > i0 ? static_cast<double>(i - i0) / static_cast<double>(i1 - i0) : 0.0;
+            for (size_t j = j0; j <= j1; j++)
+            {
+                const size_t p = i * grid.nx + j;
+                if (evaluated[p])
+                {
+                    continue;
+                }
+                const double v = j1 > j0 ? static_cast<double>(j - j0) / static_cast<double>(j1 - j0) : 0.0;
+                double *s = scores.data() + p * outputs;
+                for (size_t o = 0; o < outputs; o++)
+                {
+                    s[o] = (1 - u) * ((1 - v) * c00[o] + v * c01[o]) + u * ((1 - v) * c10[o] + v * c11[o]);
+                }
+            }
+        }
+    }
+};
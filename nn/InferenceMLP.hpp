@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+// Immutable, graph-free copy of a trained MLP. Weights are packed row-major per layer
+// (outputs x inputs) into a single contiguous array, so evaluation is plain dense math
+// without creating any Value nodes. The arrays are shared between copies and may live in
+// memory owned by someone else, e.g. a memory-mapped checkpoint.
+template <typename T = double>
+class InferenceMLP
+{
+    static_assert(std::is_floating_point<T>::value, "InferenceMLP requires a floating point type");
+
+public:
+    struct LayerSpec
+    {
+        int inputs;
+        int outputs;
+        bool nonlin;
+        bool relu;
+    };
+
+    // Number of samples evaluated together; bounds the size of the scratch buffers
+    static constexpr size_t tile_rows = 64;
+
+private:
+    std::vector<LayerSpec> layers;
+    std::vector<size_t> weight_offsets;
+    std::vector<size_t> bias_offsets;
+    std::shared_ptr<const void> storage; // keeps weights and biases alive
+    const T *weights = nullptr;
+    const T *biases = nullptr;
+    size_t weight_count = 0;
+    size_t bias_count = 0;
+    size_t max_width = 0;
+
+    void build_layout()
+    {
+        if (layers.empty())
+        {
+            throw std::invalid_argument("InferenceMLP needs at least one layer");
+        }
+
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            const LayerSpec &l = layers[i];
+            if (l.inputs <= 0 || l.outputs <= 0)
+            {
+                throw std::invalid_argument("Layer dimensions must be positive");
+            }
+            if (i > 0 && layers[i - 1].outputs != l.inputs)
+            {
+                throw std::invalid_argument("Layer input size mismatch");
+            }
+
+            weight_offsets.push_back(weight_count);
+            bias_offsets.push_back(bias_count);
+            weight_count += static_cast<size_t>(l.inputs) * l.outputs;
+            bias_count += l.outputs;
+            max_width = std::max({max_width, static_cast<size_t>(l.inputs), static_cast<size_t>(l.outputs)});
+        }
+    }
+
+    static T dot(const T *w, const T *x, int n)
+    {
+        int i = 0;
+        T sum = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+        if constexpr (std::is_same<T, double>::value)
+        {
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            for (; i + 8 <= n; i += 8)
+            {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w + i), _mm256_loadu_pd(x + i), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(w + i + 4), _mm256_loadu_pd(x + i + 4), acc1);
+            }
+            for (; i + 4 <= n; i += 4)
+            {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w + i), _mm256_loadu_pd(x + i), acc0);
+            }
+            acc0 = _mm256_add_pd(acc0, acc1);
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+            sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+        else
+        {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            for (; i + 16 <= n; i += 16)
+            {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(x + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i + 8), _mm256_loadu_ps(x + i + 8), acc1);
+            }
+            for (; i + 8 <= n; i += 8)
+            {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(x + i), acc0);
+            }
+            acc0 = _mm256_add_ps(acc0, acc1);
+            __m128 quad = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+            quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+            sum = _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1)));
+        }
+#else
+        // Independent accumulators let the compiler keep several FMAs in flight
+        T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            s0 += w[i] * x[i];
+            s1 += w[i + 1] * x[i + 1];
+            s2 += w[i + 2] * x[i + 2];
+            s3 += w[i + 3] * x[i + 3];
+        }
+        sum = (s0 + s1) + (s2 + s3);
+#endif
+        for (; i < n; i++)
+        {
+            sum += w[i] * x[i];
+        }
+        return sum;
+    }
+
+    // out[r, o] = act(b[o] + W[o, :] . in[r, :]) for a tile of rows
+    template <typename Out>
+    void dense(size_t layer, const T *in, size_t rows, Out *out) const
+    {
+        const LayerSpec &l = layers[layer];
+        const T *W = weights + weight_offsets[layer];
+        const T *b = biases + bias_offsets[layer];
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            const T *x = in + r * l.inputs;
+            Out *y = out + r * l.outputs;
+            for (int o = 0; o < l.outputs; o++)
+            {
+                T z = b[o] + dot(W + static_cast<size_t>(o) * l.inputs, x, l.inputs);
+                if (l.nonlin)
+                {
+                    z = l.relu ? (z > 0 ? z : T(0)) : std::tanh(z);
+                }
+                y[o] = static_cast<Out>(z);
+            }
+        }
+    }
+
+public:
+    InferenceMLP(std::vector<LayerSpec> specs, std::vector<T> packed_weights, std::vector<T> packed_biases)
+        : layers(std::move(specs))
+    {
+        build_layout();
+        if (packed_weights.size() != weight_count || packed_biases.size() != bias_count)
+        {
+            throw std::invalid_argument("Parameter size mismatch");
+        }
+
+        auto owned = std::make_shared<std::pair<std::vector<T>, std::vector<T>>>(std::move(packed_weights), std::move(packed_biases));
+        weights = owned->first.data();
+        biases = owned->second.data();
+        storage = owned;
+    }
+
+    // View over packed arrays owned by owner; the caller guarantees their sizes match specs
+    InferenceMLP(std::vector<LayerSpec> specs, const T *packed_weights, const T *packed_biases, std::shared_ptr<const void> owner)
+        : layers(std::move(specs)), storage(std::move(owner)), weights(packed_weights), biases(packed_biases)
+    {
+        build_layout();
+    }
+
+    int getInputs() const { return layers.front().inputs; }
+    int getOutputs() const { return layers.back().outputs; }
+    const std::vector<LayerSpec> &getLayers() const { return layers; }
+    const T *getWeights(size_t layer) const { return weights + weight_offsets[layer]; }
+    const T *getBiases(size_t layer) const { return biases + bias_offsets[layer]; }
+    size_t getWeightCount() const { return weight_count; }
+    size_t getBiasCount() const { return bias_count; }
+
+    // Number of T elements predict() needs as scratch space
+    size_t workspace_size() const { return 2 * tile_rows * max_width; }
+
+    // x is n x inputs row-major, out is n x outputs row-major. workspace must hold
+    // workspace_size() elements; no memory is allocated.
+    void predict(const double *x, size_t n, double *out, T *workspace) const
+    {
+        const size_t in_dim = getInputs();
+        const size_t out_dim = getOutputs();
+        T *buffers[2] = {workspace, workspace + tile_rows * max_width};
+
+        for (size_t r0 = 0; r0 < n; r0 += tile_rows)
+        {
+            const size_t rows = std::min(tile_rows, n - r0);
+            const T *in;
+            int current = 0;
+
+            if constexpr (std::is_same<T, double>::value)
+            {
+                in = x + r0 * in_dim;
+            }
+            else
+            {
+                std::transform(x + r0 * in_dim, x + (r0 + rows) * in_dim, buffers[1],
+                               [](double v)
+                               { return static_cast<T>(v); });
+                in = buffers[1];
+            }
+
+            for (size_t l = 0; l + 1 < layers.size(); l++)
+            {
+                dense(l, in, rows, buffers[current]);
+                in = buffers[current];
+                current ^= 1;
+            }
+            dense(layers.size() - 1, in, rows, out + r0 * out_dim);
+        }
+    }
+
+    // Convenience overload reusing a per-thread scratch buffer, so repeated calls don't allocate
+    void predict(const double *x, size_t n, double *out) const
+    {
+        thread_local std::vector<T> workspace;
+        if (workspace.size() < workspace_size())
+        {
+            workspace.resize(workspace_size());
+        }
+        predict(x, n, out, workspace.data());
+    }
+
+    std::vector<double> operator()(const std::vector<double> &x) const
+    {
+        if (x.size() != static_cast<size_t>(getInputs()))
+        {
+            throw std::invalid_argument("Input size mismatch");
+        }
+
+        std::vector<double> out(getOutputs());
+        predict(x.data(), 1, out.data());
+        return out;
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "agrad/Random.hpp"
+
+enum class InitScheme
+{
+    Uniform,        // U(-1, 1)
+    XavierUniform,  // U(-a, a), a = sqrt(6 / (fan_in + fan_out))
+    XavierNormal,   // N(0, 2 / (fan_in + fan_out))
+    KaimingUniform, // U(-a, a), a = sqrt(6 / fan_in)
+    KaimingNormal,  // N(0, 2 / fan_in)
+};
+
+// Shared weight initialization engine. Every neuron draws from its own Philox stream, and
+// stream ids are handed out in construction order, so a model built after Init::seed(s) is
+// identical on every run no matter how many threads initialize it.
+class Init
+{
+private:
+    Init() = delete;
+
+    struct State
+    {
+        std::atomic<uint64_t> seed;
+        std::atomic<uint64_t> next_stream{0};
+        State() : seed(std::random_device{}() | (static_cast<uint64_t>(std::random_device{}()) << 32)) {}
+    };
+
+    static State &state()
+    {
+        static State s;
+        return s;
+    }
+
+public:
+    // Make every model constructed from now on reproducible
+    static void seed(uint64_t value)
+    {
+        state().seed = value;
+        state().next_stream = 0;
+    }
+
+    static uint64_t get_seed() { return state().seed; }
+
+    // Reserve count consecutive stream ids and return the first
+    static uint64_t reserve_streams(uint64_t count)
+    {
+        return state().next_stream.fetch_add(count);
+    }
+
+    static void fill(double *out, size_t n, InitScheme scheme, int fan_in, int fan_out, uint64_t stream)
+    {
+        if (fan_in <= 0 || fan_out <= 0)
+        {
+            throw std::invalid_argument("fan_in and fan_out must be positive");
+        }
+
+        const uint64_t s = get_seed();
+        switch (scheme)
+        {
+        case InitScheme::Uniform:
+            Philox::uniform(out, n, -1.0, 1.0, s, stream);
+            break;
+        case InitScheme::XavierUniform:
+        {
+            double a = std::sqrt(6.0 / (fan_in + fan_out));
+            Philox::uniform(out, n, -a, a, s, stream);
+            break;
+        }
+        case InitScheme::XavierNormal:
+            Philox::normal(out, n, 0.0, std::sqrt(2.0 / (fan_in + fan_out)), s, stream);
+            break;
+        case InitScheme::KaimingUniform:
+        {
+            double a = std::sqrt(6.0 / fan_in);
+            Philox::uniform(out, n, -a, a, s, stream);
+            break;
+        }
+        case InitScheme::KaimingNormal:
+            Philox::normal(out, n, 0.0, std::sqrt(2.0 / fan_in), s, stream);
+            break;
+        }
+    }
+};
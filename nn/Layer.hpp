@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+
+#include "agrad/Parallel.hpp"
+#include "nn/Init.hpp"
 #include "nn/Module.hpp"
 #include "nn/Neuron.hpp"
 
@@ -12,16 +17,55 @@ private:
     bool relu;
     std::vector<Neuron> neurons;
 
+    // Layers with fewer weights than this are not worth spawning threads for
+    static constexpr size_t parallel_init_threshold = 1 << 16;
+
 public:
-    Layer(int inputs, int outputs, bool nonlin, bool relu = true) : inputs(inputs), outputs(outputs), nonlin(nonlin), relu(relu)
+    Layer(int inputs, int outputs, bool nonlin, bool relu = true, InitScheme init = InitScheme::Uniform) : inputs(inputs), outputs(outputs), nonlin(nonlin), relu(relu)
     {
-        for (int i = 0; i < outputs; i++)
+        // Neuron i always uses stream first_stream + i, so the weights don't depend on the thread count
+        const uint64_t first_stream = Init::reserve_streams(outputs);
+        const size_t weights = static_cast<size_t>(inputs) * outputs;
+        const size_t threads = weights < parallel_init_threshold ? 1 : agrad::thread_count(0);
+
+        std::vector<std::vector<Neuron>> parts(threads);
+        const size_t used = agrad::parallel_ranges(outputs, threads, 1, [&](size_t t, size_t begin, size_t end)
+                                                   {
+            parts[t].reserve(end - begin);
+            for (size_t i = begin; i < end; i++)
+            {
+                parts[t].emplace_back(inputs, nonlin, relu, init, outputs, first_stream + i);
+            } });
+
+        neurons.reserve(outputs);
+        for (size_t t = 0; t < used; t++)
         {
-            Neuron n(inputs, nonlin, relu);
-            neurons.push_back(n);
+            std::move(parts[t].begin(), parts[t].end(), std::back_inserter(neurons));
         }
     }
 
+    // Frozen weights, row-major outputs x inputs; nothing is drawn from Init
+    template <typename T>
+    Layer(int inputs, int outputs, bool nonlin, bool relu, const T *weights, const T *biases) : inputs(inputs), outputs(outputs), nonlin(nonlin), relu(relu)
+    {
+        neurons.reserve(outputs);
+        for (int n = 0; n < outputs; n++)
+        {
+            std::vector<Value::ValuePtr> w;
+            w.reserve(inputs);
+            for (int i = 0; i < inputs; i++)
+            {
+                w.push_back(Value::create(weights[static_cast<size_t>(n) * inputs + i], "w" + std::to_string(i)));
+            }
+            neurons.emplace_back(Value::create(biases[n], "b"), std::move(w), nonlin, relu);
+        }
+    }
+
+    int getInputs() const { return inputs; }
+    int getOutputs() const { return outputs; }
+    bool isNonlin() const { return nonlin; }
+    bool isRelu() const { return relu; }
+
     std::vector<Value::ValuePtr> parameters() const override
     {
         std::vector<Value::ValuePtr> params;
@@ -47,9 +91,10 @@ public:
         }
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<double> x)
+    std::vector<Value::ValuePtr> operator()(const std::vector<double> &x)
     {
         std::vector<Value::ValuePtr> out;
+        out.reserve(neurons.size());
         for (Neuron &n : neurons)
         {
             out.push_back(n(x));
@@ -57,9 +102,10 @@ public:
         return out;
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<Value::ValuePtr> x)
+    std::vector<Value::ValuePtr> operator()(const std::vector<Value::ValuePtr> &x)
     {
         std::vector<Value::ValuePtr> out;
+        out.reserve(neurons.size());
         for (Neuron &n : neurons)
         {
             out.push_back(n(x));
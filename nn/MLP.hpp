@@ -1,6 +1,9 @@
 #pragma once
 
+#include "agrad/Trace.hpp"
 #include "agrad/Value.hpp"
+#include "nn/Checkpoint.hpp"
+#include "nn/InferenceMLP.hpp"
 #include "nn/Layer.hpp"
 #include "nn/Module.hpp"
 
@@ -15,14 +18,28 @@ private:
     std::vector<Layer> layers;
 
 public:
-    MLP(int inputs, std::vector<int> outputs, bool relu = true) : inputs(inputs), outputs(outputs), relu(relu)
+    MLP(int inputs, std::vector<int> outputs, bool relu = true, InitScheme init = InitScheme::Uniform) : inputs(inputs), outputs(outputs), relu(relu)
     {
         std::vector<int> dims = {inputs};
         dims.insert(dims.end(), outputs.begin(), outputs.end());
+        layers.reserve(outputs.size());
         for (int i = 0; i < outputs.size(); i++)
         {
-            Layer l(dims[i], dims[i + 1], i != outputs.size() - 1, relu);
-            layers.push_back(l);
+            layers.emplace_back(dims[i], dims[i + 1], i != outputs.size() - 1, relu, init);
+        }
+    }
+
+    // Rebuild a trainable model from frozen weights
+    template <typename T>
+    explicit MLP(const InferenceMLP<T> &frozen) : inputs(frozen.getInputs()), relu(frozen.getLayers().front().relu)
+    {
+        const auto &specs = frozen.getLayers();
+        layers.reserve(specs.size());
+        for (size_t l = 0; l < specs.size(); l++)
+        {
+            const auto &spec = specs[l];
+            outputs.push_back(spec.outputs);
+            layers.emplace_back(spec.inputs, spec.outputs, spec.nonlin, spec.relu, frozen.getWeights(l), frozen.getBiases(l));
         }
     }
 
@@ -49,31 +66,71 @@ public:
         }
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<Value::ValuePtr> x)
+    // Snapshot the current parameters into a graph-free model for fast inference
+    template <typename T = double>
+    InferenceMLP<T> freeze() const
     {
-        auto current = layers[0](x);
+        std::vector<typename InferenceMLP<T>::LayerSpec> specs;
+        std::vector<T> weights;
+        std::vector<T> biases;
 
-        for (int i = 1; i < layers.size(); i++)
+        for (const Layer &layer : layers)
         {
-            current = layers[i](current);
+            specs.push_back({layer.getInputs(), layer.getOutputs(), layer.isNonlin(), layer.isRelu()});
+
+            // Each neuron contributes [b, w0, ..., wn] to parameters()
+            auto params = layer.parameters();
+            const size_t stride = layer.getInputs() + 1;
+            for (size_t n = 0; n < static_cast<size_t>(layer.getOutputs()); n++)
+            {
+                biases.push_back(static_cast<T>(params[n * stride]->getData()));
+                for (size_t i = 1; i < stride; i++)
+                {
+                    weights.push_back(static_cast<T>(params[n * stride + i]->getData()));
+                }
+            }
         }
 
-        return current;
+        return InferenceMLP<T>(std::move(specs), std::move(weights), std::move(biases));
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<double> x)
+    // Write the current weights as a binary checkpoint (see nn/Checkpoint.hpp)
+    template <typename T = double>
+    void save(const std::string &filename) const
     {
-        auto current = layers[0](x);
+        Checkpoint::save(freeze<T>(), filename);
+    }
 
-        for (int i = 1; i < layers.size(); i++)
+    static MLP load(const std::string &filename)
+    {
+        return MLP(Checkpoint::load<double>(filename));
+    }
+
+    std::vector<Value::ValuePtr> operator()(const std::vector<Value::ValuePtr> &x)
+    {
+        std::vector<Value::ValuePtr> current;
+        for (int i = 0; i < layers.size(); i++)
+        {
+            agrad::trace::Scope span("layer", "nn", i);
+            current = i == 0 ? layers[0](x) : layers[i](current);
+        }
+
+        return current;
+    }
+
+    std::vector<Value::ValuePtr> operator()(const std::vector<double> &x)
+    {
+        std::vector<Value::ValuePtr> current;
+        for (int i = 0; i < layers.size(); i++)
         {
-            current = layers[i](current);
+            agrad::trace::Scope span("layer", "nn", i);
+            current = i == 0 ? layers[0](x) : layers[i](current);
         }
 
         return current;
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<std::vector<double>> x)
+    std::vector<Value::ValuePtr> operator()(const std::vector<std::vector<double>> &x)
     {
         std::vector<Value::ValuePtr> output;
         for (int i = 0; i < x.size(); i++)
@@ -85,7 +142,7 @@ public:
         return output;
     }
 
-    std::vector<Value::ValuePtr> operator()(std::vector<std::vector<Value::ValuePtr>> x)
+    std::vector<Value::ValuePtr> operator()(const std::vector<std::vector<Value::ValuePtr>> &x)
     {
         std::vector<Value::ValuePtr> output;
         for (int i = 0; i < x.size(); i++)
@@ -0,0 +1,449 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "agrad/Parallel.hpp"
+#include "agrad/Trace.hpp"
+#include "data/Dataset.hpp"
+#include "nn/DecisionMap.hpp"
+
+// 8-bit RGB image, rows top to bottom, written as binary PPM or PNG without any library
+class Image
+{
+private:
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<uint8_t> pixels;
+
+    // Deflate output, least significant bit first
+    class BitWriter
+    {
+    private:
+        std::vector<uint8_t> &out;
+        uint64_t buffer = 0;
+        int bits = 0;
+
+    public:
+        explicit BitWriter(std::vector<uint8_t> &out) : out(out) {}
+
+        void write(uint32_t value, int count)
+        {
+            buffer |= static_cast<uint64_t>(value) << bits;
+            bits += count;
+            while (bits >= 8)
+            {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer >>= 8;
+                bits -= 8;
+            }
+        }
+
+        // Huffman codes are defined most significant bit first
+        void write_code(uint32_t code, int count)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < count; i++)
+            {
+                reversed |= ((code >> i) & 1u) << (count - 1 - i);
+            }
+            write(reversed, count);
+        }
+
+        void flush()
+        {
+            if (bits > 0)
+            {
+                out.push_back(static_cast<uint8_t>(buffer));
+            }
+            buffer = 0;
+            bits = 0;
+        }
+    };
+
+    static void literal(BitWriter &bits, uint32_t value)
+    {
+        if (value < 144)
+        {
+            bits.write_code(0x30 + value, 8);
+        }
+        else if (value < 256)
+        {
+            bits.write_code(0x190 + value - 144, 9);
+        }
+        else if (value < 280)
+        {
+            bits.write_code(value - 256, 7);
+        }
+        else
+        {
+            bits.write_code(0xC0 + value - 280, 8);
+        }
+    }
+
+    // A repeat of the previous byte, length 3 to 258
+    static void repeat(BitWriter &bits, size_t length)
+    {
+        static constexpr uint16_t base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                              35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr uint8_t extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        size_t code = 28;
+        while (base[code] > length)
+        {
+            code--;
+        }
+        literal(bits, static_cast<uint32_t>(257 + code));
+        bits.write(static_cast<uint32_t>(length - base[code]), extra[code]);
+        bits.write_code(0, 5); // distance 1
+    }
+
+    // zlib stream of one fixed-Huffman deflate block. The only matches are runs of the
+    // previous byte, which is where filtered rows of flat colour regions end up.
+    static std::vector<uint8_t> deflate(const std::vector<uint8_t> &data)
+    {
+        std::vector<uint8_t> out = {0x78, 0x01};
+        BitWriter bits(out);
+        bits.write(1, 1); // final block
+        bits.write(1, 2); // fixed Huffman codes
+
+        for (size_t p = 0; p < data.size();)
+        {
+            size_t run = 0;
+            if (p > 0)
+            {
+                while (run < 258 && p + run < data.size() && data[p + run] == data[p - 1])
+                {
+                    run++;
+                }
+            }
+            if (run >= 3)
+            {
+                repeat(bits, run);
+                p += run;
+            }
+            else
+            {
+                literal(bits, data[p++]);
+            }
+        }
+        literal(bits, 256); // end of block
+        bits.flush();
+
+        uint32_t a = 1, b = 0;
+        for (size_t p = 0; p < data.size();)
+        {
+            // 5552 bytes is the most that can be summed before b overflows
+            const size_t end = std::min(data.size(), p + 5552);
+            for (; p < end; p++)
+            {
+                a += data[p];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        put_be32(out, (b << 16) | a);
+        return out;
+    }
+
+    static uint32_t crc32(const uint8_t *data, size_t n, uint32_t crc = 0)
+    {
+        static const std::array<uint32_t, 256> table = []()
+        {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t i = 0; i < n; i++)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    static void put_be32(std::vector<uint8_t> &out, uint32_t v)
+    {
+        out.push_back(static_cast<uint8_t>(v >> 24));
+        out.push_back(static_cast<uint8_t>(v >> 16));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static void put_chunk(std::ofstream &out, const char type[4], const std::vector<uint8_t> &data)
+    {
+        std::vector<uint8_t> chunk;
+        put_be32(chunk, static_cast<uint32_t>(data.size()));
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        put_be32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+        out.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+    }
+
+    // PNG scanlines, each with the filter (none, left or up) that leaves the fewest
+    // non-zero bytes
+    std::vector<uint8_t> filtered_rows() const
+    {
+        const size_t stride = width * 3;
+        std::vector<uint8_t> rows((stride + 1) * height);
+        std::vector<uint8_t> candidate[3];
+        for (auto &c : candidate)
+        {
+            c.resize(stride);
+        }
+        for (size_t y = 0; y < height; y++)
+        {
+            const uint8_t *row = pixels.data() + y * stride;
+            const uint8_t *above = y > 0 ? row - stride : nullptr;
+            size_t best = 0, best_nonzero = stride + 1;
+            for (size_t f = 0; f < 3; f++)
+            {
+                size_t nonzero = 0;
+                for (size_t i = 0; i < stride; i++)
+                {
+                    const uint8_t prior = f == 1 ? (i >= 3 ? row[i - 3] : 0) : f == 2 ? (above ? above[i] : 0) : 0;
+                    candidate[f][i] = static_cast<uint8_t>(row[i] - prior);
+                    nonzero += candidate[f][i] != 0;
+                }
+                if (nonzero < best_nonzero)
+                {
+                    best = f;
+                    best_nonzero = nonzero;
+                }
+            }
+            uint8_t *out = rows.data() + y * (stride + 1);
+            out[0] = static_cast<uint8_t>(best);
+            std::copy(candidate[best].begin(), candidate[best].end(), out + 1);
+        }
+        return rows;
+    }
+
+public:
+    Image() = default;
+    Image(size_t width, size_t height, std::array<uint8_t, 3> fill = {255, 255, 255})
+        : width(width), height(height), pixels(width * height * 3)
+    {
+        for (size_t p = 0; p < width * height; p++)
+        {
+            std::copy(fill.begin(), fill.end(), pixels.begin() + p * 3);
+        }
+    }
+
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+    uint8_t *pixel(size_t x, size_t y) { return pixels.data() + (y * width + x) * 3; }
+    const uint8_t *pixel(size_t x, size_t y) const { return pixels.data() + (y * width + x) * 3; }
+
+    void write_ppm(const std::string &filename) const
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+        out << "P6\n"
+            << width << " " << height << "\n255\n";
+        out.write(reinterpret_cast<const char *>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing image: " + filename);
+        }
+    }
+
+    void write_png(const std::string &filename) const
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+        static constexpr uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+
+        std::vector<uint8_t> header;
+        put_be32(header, static_cast<uint32_t>(width));
+        put_be32(header, static_cast<uint32_t>(height));
+        header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, no interlace
+        put_chunk(out, "IHDR", header);
+        put_chunk(out, "IDAT", deflate(filtered_rows()));
+        put_chunk(out, "IEND", {});
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing image: " + filename);
+        }
+    }
+
+    // Format from the extension: .png or .ppm
+    void save(const std::string &filename) const
+    {
+        const auto ends_with = [&](const std::string &suffix)
+        {
+            return filename.size() >= suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        if (ends_with(".png"))
+        {
+            write_png(filename);
+        }
+        else if (ends_with(".ppm"))
+        {
+            write_ppm(filename);
+        }
+        else
+        {
+            throw std::invalid_argument("Image file must end in .png or .ppm: " + filename);
+        }
+    }
+};
+
+struct RenderOptions
+{
+    int point_radius = 3;  // 0 leaves the data points out
+    bool boundary = true;  // darken pixels where the predicted class changes
+    bool shade = true;     // fade single-output regions towards white where the score is near 0
+    bool adaptive = true;  // evaluate the model with DecisionMap::adaptive rather than densely
+    size_t threads = 0;    // for evaluation and colouring; 0 picks one per core
+};
+
+// Draws a DecisionMap, one pixel per grid point with y pointing up, and the points of a
+// dataset over it, without a display or plotting library. Regions take a light tint of
+// their class colour and points the full colour: red for +1, blue for -1 and a fixed
+// palette for multiclass indices.
+//
+// write_async() takes a frozen model and does all the work on a background thread, so
+// a training loop can write a diagnostic image every epoch and keep going.
+class MapRenderer
+{
+private:
+    using Color = std::array<uint8_t, 3>;
+
+    static Color class_color(int label)
+    {
+        static constexpr Color palette[8] = {{40, 70, 220}, {220, 40, 40}, {30, 160, 60}, {230, 150, 20},
+                                             {140, 60, 190}, {20, 170, 180}, {200, 60, 150}, {120, 120, 120}};
+        // Binary labels -1 and +1 take the first two colours
+        const int index = label < 0 ? 0 : label == 1 ? 1
+                                                       : label;
+        return palette[static_cast<size_t>(index) % 8];
+    }
+
+    // weight 1 gives color, 0 gives white
+    static Color tint(const Color &color, double weight)
+    {
+        Color out;
+        for (size_t c = 0; c < 3; c++)
+        {
+            out[c] = static_cast<uint8_t>(std::lround(255.0 - (255.0 - color[c]) * weight));
+        }
+        return out;
+    }
+
+    static void draw_points(Image &image, const DecisionGrid &grid, const Dataset &dataset, int radius)
+    {
+        const long width = static_cast<long>(image.getWidth());
+        const long height = static_cast<long>(image.getHeight());
+        for (size_t n = 0; n < dataset.size(); n++)
+        {
+            const double *x = dataset.row(n);
+            const long cx = std::lround((x[0] - grid.x_min) / grid.dx);
+            const long cy = height - 1 - std::lround((x[1] - grid.y_min) / grid.dy);
+            const double label = dataset.label(n);
+            const Color fill = class_color(dataset.getLabelType() == LabelType::Binary ? (label > 0 ? 1 : -1) : static_cast<int>(label));
+            for (long dy = -radius; dy <= radius; dy++)
+            {
+                for (long dx = -radius; dx <= radius; dx++)
+                {
+                    const long px = cx + dx, py = cy + dy;
+                    const long d2 = dx * dx + dy * dy;
+                    if (px < 0 || py < 0 || px >= width || py >= height || d2 > radius * radius)
+                    {
+                        continue;
+                    }
+                    // One-pixel dark outline
+                    const Color c = d2 > (radius - 1) * (radius - 1) ? Color{30, 30, 30} : fill;
+                    std::copy(c.begin(), c.end(), image.pixel(px, py));
+                }
+            }
+        }
+    }
+
+public:
+    static Image render(const DecisionMap &map, const Dataset *dataset = nullptr, const RenderOptions &options = {})
+    {
+        agrad::trace::Scope span("render_map", "nn");
+        const DecisionGrid &grid = map.getGrid();
+        Image image(grid.nx, grid.ny);
+        if (grid.size() == 0)
+        {
+            return image;
+        }
+
+        auto rows = [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; y++)
+            {
+                const size_t i = grid.ny - 1 - y;
+                for (size_t j = 0; j < grid.nx; j++)
+                {
+                    const int label = map.label(i, j);
+                    double weight = 0.3;
+                    if (options.shade && map.getOutputs() == 1)
+                    {
+                        weight = 0.12 + 0.23 * std::min(1.0, std::abs(map.score(i, j)));
+                    }
+                    Color c = tint(class_color(label), weight);
+                    if (options.boundary && ((j + 1 < grid.nx && map.label(i, j + 1) != label) || (i > 0 && map.label(i - 1, j) != label)))
+                    {
+                        c = {60, 60, 60};
+                    }
+                    std::copy(c.begin(), c.end(), image.pixel(j, y));
+                }
+            }
+        };
+
+        agrad::parallel_ranges(grid.ny, options.threads, 1, [&](size_t, size_t begin, size_t end)
+                               { rows(begin, end); });
+
+        if (dataset && options.point_radius > 0)
+        {
+            draw_points(image, grid, *dataset, options.point_radius);
+        }
+        return image;
+    }
+
+    // Evaluates model over grid and writes the picture to filename (.png or .ppm)
+    template <typename Model>
+    static void write(const Model &model, const DecisionGrid &grid, const Dataset &dataset,
+                       const std::string &filename, const RenderOptions &options = {})
+    {
+        const DecisionMap map = options.adaptive ? DecisionMap::adaptive(model, grid, 16, options.threads)
+                                                 : DecisionMap::evaluate(model, grid, options.threads);
+        render(map, &dataset, options).save(filename);
+    }
+
+    // write() on a background thread. model is copied, so pass a frozen snapshot (copies of
+    // an InferenceMLP share weights that never change) and keep training; the future
+    // rethrows any error from get().
+    template <typename Model>
+    static std::future<void> write_async(Model model, const DecisionGrid &grid, Dataset dataset,
+                                          std::string filename, RenderOptions options = {})
+    {
+        return std::async(std::launch::async, [model = std::move(model), grid, dataset = std::move(dataset),
+                                               filename = std::move(filename), options]()
+                          { write(model, grid, dataset, filename, options); });
+    }
+};
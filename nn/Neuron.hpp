@@ -1,7 +1,7 @@
 #pragma once
+#include "nn/Init.hpp"
 #include "nn/Module.hpp"
 #include <vector>
-#include <random>
 #include <iostream>
 #include <string>
 
@@ -13,29 +13,35 @@ private:
     bool nonlin;
     bool relu;
     int inputs;
-    void initialize_weights()
+    void initialize_weights(InitScheme scheme, int fan_out, uint64_t stream)
     {
-        // Create a random number generator
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+        thread_local std::vector<double> values;
+        values.resize(inputs);
+        Init::fill(values.data(), inputs, scheme, inputs, fan_out, stream);
 
+        w.reserve(inputs);
         for (int i = 0; i < inputs; i++)
         {
-            auto v = Value::create(dis(gen), "w" + std::to_string(i));
-            w.push_back(v);
+            w.push_back(Value::create(values[i], "w" + std::to_string(i)));
         }
     }
 
 public:
     Neuron(int inputs) : b(Value::create(0, "b")), nonlin(true), inputs(inputs), relu(true)
     {
-        initialize_weights();
+        initialize_weights(InitScheme::Uniform, 1, Init::reserve_streams(1));
     };
     Neuron(int inputs, bool nonlin, bool relu = true) : b(Value::create(0, "b")), nonlin(nonlin), inputs(inputs), relu(relu)
     {
-        initialize_weights();
+        initialize_weights(InitScheme::Uniform, 1, Init::reserve_streams(1));
     };
+    // Draws its weights from the given stream of the shared Init engine
+    Neuron(int inputs, bool nonlin, bool relu, InitScheme scheme, int fan_out, uint64_t stream) : b(Value::create(0, "b")), nonlin(nonlin), inputs(inputs), relu(relu)
+    {
+        initialize_weights(scheme, fan_out, stream);
+    };
+    // Takes ready-made parameters, so no Init stream is used
+    Neuron(Value::ValuePtr b, std::vector<Value::ValuePtr> w, bool nonlin, bool relu) : w(std::move(w)), b(std::move(b)), nonlin(nonlin), relu(relu), inputs(static_cast<int>(this->w.size())) {};
     std::vector<Value::ValuePtr> parameters() const override
     {
         std::vector<Value::ValuePtr> p{b};
@@ -64,41 +70,33 @@ public:
         return os;
     }
 
-    Value::ValuePtr operator()(std::vector<Value::ValuePtr> x)
+    Value::Activation activation() const
     {
-        if (x.size() != inputs)
-        {
-            throw std::invalid_argument("Input size mismatch");
-        }
-
-        auto out = Value::create(b); // Start with bias
-
-        for (size_t i = 0; i < inputs; i++)
+        if (!nonlin)
         {
-            out = out + x[i] * w[i];
+            return Value::Activation::None;
         }
+        return relu ? Value::Activation::ReLU : Value::Activation::Tanh;
+    }
 
-        if (nonlin)
+    // One fused node computing act(w . x + b)
+    Value::ValuePtr operator()(const std::vector<Value::ValuePtr> &x)
+    {
+        if (x.size() != inputs)
         {
-            out = relu ? out->relu() : out->tanh();
+            throw std::invalid_argument("Input size mismatch");
         }
 
-        return out;
+        return Value::linear(w, x, b, activation());
     }
 
-    Value::ValuePtr operator()(std::vector<double> x)
+    Value::ValuePtr operator()(const std::vector<double> &x)
     {
         if (x.size() != inputs)
         {
             throw std::invalid_argument("Input size mismatch");
         }
 
-        std::vector<Value::ValuePtr> x_vals;
-        for (size_t i = 0; i < inputs; i++)
-        {
-            x_vals.push_back(Value::create(x[i]));
-        }
-
-        return (*this)(x_vals);
+        return Value::linear(w, x, b, activation());
     }
 };
\ No newline at end of file
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "data/DataLoader.hpp"
+#include "nn/InferenceMLP.hpp"
+#include "nn/MLP.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Accuracy of a quantized model measured against the float model it was derived from
+struct QuantizationReport
+{
+    size_t samples = 0;
+    double float_accuracy = 0.0;
+    double quantized_accuracy = 0.0;
+    double agreement = 0.0; // fraction of samples where both models predict the same class
+    double max_abs_error = 0.0;
+    double mean_abs_error = 0.0;
+
+    friend std::ostream &operator<<(std::ostream &os, const QuantizationReport &report)
+    {
+        os << "Quantization report (" << report.samples << " samples):" << std::endl;
+        os << "  Float accuracy:     " << report.float_accuracy * 100.0 << "%" << std::endl;
+        os << "  Int8 accuracy:      " << report.quantized_accuracy * 100.0 << "%" << std::endl;
+        os << "  Agreement:          " << report.agreement * 100.0 << "%" << std::endl;
+        os << "  Max abs error:      " << report.max_abs_error << std::endl;
+        os << "  Mean abs error:     " << report.mean_abs_error << std::endl;
+        return os;
+    }
+};
+
+// Post-training int8 quantization of an MLP. Weights are stored as int8 with one scale per
+// neuron, activations are quantized per layer with a static scale found on a calibration
+// sample, and every dense layer runs as an integer dot product accumulated in int32.
+class QuantizedMLP
+{
+public:
+    // Quantized rows are zero-padded to this many int8 values so the SIMD kernels need no tail loop
+    static constexpr size_t row_alignment = 32;
+    static constexpr size_t tile_rows = 64;
+
+private:
+    struct QuantizedLayer
+    {
+        int inputs;
+        int outputs;
+        bool nonlin;
+        bool relu;
+        size_t stride;        // padded row length of weights and quantized inputs
+        size_t weight_offset; // into weights
+        size_t neuron_offset; // into scales, row_sums and biases
+        float input_scale;    // real value of one input quantization step
+    };
+
+    std::vector<QuantizedLayer> layers;
+    std::vector<int8_t> weights;
+    std::vector<float> scales;     // per neuron: weight scale * input scale
+    std::vector<int32_t> row_sums; // per neuron: sum of its int8 weights, used by the VNNI path
+    std::vector<double> biases;
+    size_t max_width = 0;
+    size_t max_stride = 0;
+
+    QuantizedMLP() = default;
+
+    static size_t padded(size_t n)
+    {
+        return (n + row_alignment - 1) / row_alignment * row_alignment;
+    }
+
+    static int8_t quantize_value(double v, double inv_scale)
+    {
+        double q = std::nearbyint(v * inv_scale);
+        return static_cast<int8_t>(std::max(-127.0, std::min(127.0, q)));
+    }
+
+    // Sum of w[i] * x[i] over n int8 values, n a multiple of row_alignment
+    static int32_t dot(const int8_t *w, const int8_t *x, size_t n, int32_t w_sum)
+    {
+#if (defined(__AVX512VNNI__) && defined(__AVX512VL__)) || defined(__AVXVNNI__)
+        // vpdpbusd multiplies unsigned by signed bytes: shift x into [1, 255] by flipping the
+        // sign bit (x + 128), then remove the 128 * sum(w) that adds
+        const __m256i flip = _mm256_set1_epi8(static_cast<char>(0x80));
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t i = 0; i < n; i += 32)
+        {
+            __m256i xu = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)), flip);
+            __m256i ws = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+            acc = _mm256_dpbusd_epi32(acc, xu, ws);
+#else
+            acc = _mm256_dpbusd_avx_epi32(acc, xu, ws);
+#endif
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s) - 128 * w_sum;
+#elif defined(__AVX2__)
+        // Widen to int16 and let vpmaddwd sum adjacent products into int32 lanes
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t i = 0; i < n; i += 16)
+        {
+            __m256i xs = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+            __m256i ws = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(xs, ws));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+#else
+        (void)w_sum;
+        int32_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += static_cast<int32_t>(w[i]) * static_cast<int32_t>(x[i]);
+        }
+        return sum;
+#endif
+    }
+
+    // Float forward pass of one layer, used while calibrating
+    static void dense_float(const InferenceMLP<double> &model, size_t layer, const std::vector<double> &in, std::vector<double> &out)
+    {
+        const auto &l = model.getLayers()[layer];
+        const double *W = model.getWeights(layer);
+        const double *b = model.getBiases(layer);
+        out.assign(l.outputs, 0.0);
+        for (int o = 0; o < l.outputs; o++)
+        {
+            double z = b[o];
+            for (int i = 0; i < l.inputs; i++)
+            {
+                z += W[static_cast<size_t>(o) * l.inputs + i] * in[i];
+            }
+            if (l.nonlin)
+            {
+                z = l.relu ? std::max(0.0, z) : std::tanh(z);
+            }
+            out[o] = z;
+        }
+    }
+
+public:
+    // Quantize a frozen model, calibrating activation ranges on up to calibration_size rows
+    // drawn at random from calibration
+    static QuantizedMLP quantize(const InferenceMLP<double> &model, const Dataset &calibration,
+                                 size_t calibration_size = 256, unsigned int seed = 0)
+    {
+        if (calibration.empty())
+        {
+            throw std::invalid_argument("Calibration dataset is empty");
+        }
+        if (calibration.feature_dim() != static_cast<size_t>(model.getInputs()))
+        {
+            throw std::invalid_argument("Input size mismatch");
+        }
+
+        const auto &specs = model.getLayers();
+
+        // Draw the calibration sample
+        std::vector<size_t> rows(calibration.size());
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            rows[i] = i;
+        }
+        std::mt19937 gen(seed);
+        std::shuffle(rows.begin(), rows.end(), gen);
+        rows.resize(std::min(calibration_size, rows.size()));
+
+        // Largest absolute input seen by each layer
+        std::vector<double> max_abs(specs.size(), 0.0);
+        std::vector<double> current, next;
+        for (size_t r : rows)
+        {
+            current = calibration.row_vector(r);
+            for (size_t l = 0; l < specs.size(); l++)
+            {
+                for (double v : current)
+                {
+                    max_abs[l] = std::max(max_abs[l], std::abs(v));
+                }
+                dense_float(model, l, current, next);
+                std::swap(current, next);
+            }
+        }
+
+        QuantizedMLP q;
+        for (size_t l = 0; l < specs.size(); l++)
+        {
+            const auto &s = specs[l];
+            QuantizedLayer ql;
+            ql.inputs = s.inputs;
+            ql.outputs = s.outputs;
+            ql.nonlin = s.nonlin;
+            ql.relu = s.relu;
+            ql.stride = padded(s.inputs);
+            ql.weight_offset = q.weights.size();
+            ql.neuron_offset = q.biases.size();
+            ql.input_scale = static_cast<float>(max_abs[l] > 0.0 ? max_abs[l] / 127.0 : 1.0);
+
+            const double *W = model.getWeights(l);
+            const double *b = model.getBiases(l);
+            q.weights.resize(q.weights.size() + ql.stride * s.outputs, 0);
+
+            for (int o = 0; o < s.outputs; o++)
+            {
+                const double *w_row = W + static_cast<size_t>(o) * s.inputs;
+                double w_max = 0.0;
+                for (int i = 0; i < s.inputs; i++)
+                {
+                    w_max = std::max(w_max, std::abs(w_row[i]));
+                }
+                double w_scale = w_max > 0.0 ? w_max / 127.0 : 1.0;
+
+                int8_t *q_row = q.weights.data() + ql.weight_offset + o * ql.stride;
+                int32_t sum = 0;
+                for (int i = 0; i < s.inputs; i++)
+                {
+                    q_row[i] = quantize_value(w_row[i], 1.0 / w_scale);
+                    sum += q_row[i];
+                }
+
+                q.scales.push_back(static_cast<float>(w_scale * ql.input_scale));
+                q.row_sums.push_back(sum);
+                q.biases.push_back(b[o]);
+            }
+
+            q.max_width = std::max({q.max_width, static_cast<size_t>(s.inputs), static_cast<size_t>(s.outputs)});
+            q.max_stride = std::max(q.max_stride, ql.stride);
+            q.layers.push_back(ql);
+        }
+
+        return q;
+    }
+
+    static QuantizedMLP quantize(const MLP &model, const Dataset &calibration,
+                                 size_t calibration_size = 256, unsigned int seed = 0)
+    {
+        return quantize(model.freeze(), calibration, calibration_size, seed);
+    }
+
+    int getInputs() const { return layers.front().inputs; }
+    int getOutputs() const { return layers.back().outputs; }
+    float getInputScale(size_t layer) const { return layers[layer].input_scale; }
+
+    // Same contract as InferenceMLP::predict: x is n x inputs, out is n x outputs, row-major
+    void predict(const double *x, size_t n, double *out) const
+    {
+        thread_local std::vector<double> activations;
+        thread_local std::vector<int8_t> quantized;
+        if (activations.size() < 2 * tile_rows * max_width)
+        {
+            activations.resize(2 * tile_rows * max_width);
+        }
+        if (quantized.size() < max_stride)
+        {
+            quantized.resize(max_stride);
+        }
+
+        const size_t in_dim = getInputs();
+        const size_t out_dim = getOutputs();
+        double *buffers[2] = {activations.data(), activations.data() + tile_rows * max_width};
+
+        for (size_t r0 = 0; r0 < n; r0 += tile_rows)
+        {
+            const size_t rows = std::min(tile_rows, n - r0);
+            const double *in = x + r0 * in_dim;
+            int current = 0;
+
+            for (size_t l = 0; l < layers.size(); l++)
+            {
+                const QuantizedLayer &ql = layers[l];
+                const bool last = l + 1 == layers.size();
+                double *dst = last ? out + r0 * out_dim : buffers[current];
+                const double inv_scale = 1.0 / ql.input_scale;
+                const int8_t *W = weights.data() + ql.weight_offset;
+
+                for (size_t r = 0; r < rows; r++)
+                {
+                    const double *xr = in + r * ql.inputs;
+                    for (int i = 0; i < ql.inputs; i++)
+                    {
+                        quantized[i] = quantize_value(xr[i], inv_scale);
+                    }
+                    std::fill(quantized.begin() + ql.inputs, quantized.begin() + ql.stride, 0);
+
+                    double *yr = dst + r * ql.outputs;
+                    for (int o = 0; o < ql.outputs; o++)
+                    {
+                        const size_t k = ql.neuron_offset + o;
+                        int32_t acc = dot(W + o * ql.stride, quantized.data(), ql.stride, row_sums[k]);
+                        double z = acc * static_cast<double>(scales[k]) + biases[k];
+                        if (ql.nonlin)
+                        {
+                            z = ql.relu ? std::max(0.0, z) : std::tanh(z);
+                        }
+                        yr[o] = z;
+                    }
+                }
+
+                in = dst;
+                current ^= 1;
+            }
+        }
+    }
+
+    std::vector<double> operator()(const std::vector<double> &x) const
+    {
+        if (x.size() != static_cast<size_t>(getInputs()))
+        {
+            throw std::invalid_argument("Input size mismatch");
+        }
+
+        std::vector<double> out(getOutputs());
+        predict(x.data(), 1, out.data());
+        return out;
+    }
+
+    // Compare against the float model on a held-out dataset with -1/1 labels. The predicted
+    // class is the sign of the first output.
+    static QuantizationReport compare(const InferenceMLP<double> &reference, const QuantizedMLP &quantized, const Dataset &test)
+    {
+        QuantizationReport report;
+        const size_t n = test.size();
+        report.samples = n;
+        if (n == 0)
+        {
+            return report;
+        }
+
+        // Contiguous views are already the row-major block predict() takes
+        const Dataset packed = test.is_contiguous() ? test : test.materialize();
+        const size_t out_dim = reference.getOutputs();
+        std::vector<double> expected(n * out_dim);
+        std::vector<double> actual(n * out_dim);
+        reference.predict(packed.data(), n, expected.data());
+        quantized.predict(packed.data(), n, actual.data());
+
+        double error_sum = 0.0;
+        size_t float_correct = 0, quantized_correct = 0, agree = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t o = 0; o < out_dim; o++)
+            {
+                double err = std::abs(expected[i * out_dim + o] - actual[i * out_dim + o]);
+                report.max_abs_error = std::max(report.max_abs_error, err);
+                error_sum += err;
+            }
+
+            bool float_pos = expected[i * out_dim] > 0;
+            bool quantized_pos = actual[i * out_dim] > 0;
+            bool label_pos = packed.label(i) == 1;
+            float_correct += float_pos == label_pos;
+            quantized_correct += quantized_pos == label_pos;
+            agree += float_pos == quantized_pos;
+        }
+
+        report.float_accuracy = static_cast<double>(float_correct) / n;
+        report.quantized_accuracy = static_cast<double>(quantized_correct) / n;
+        report.agreement = static_cast<double>(agree) / n;
+        report.mean_abs_error = error_sum / (n * out_dim);
+        return report;
+    }
+};
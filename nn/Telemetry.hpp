@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "agrad/Trace.hpp"
+
+enum class TelemetryFormat
+{
+    JsonLines,
+    Csv,
+};
+
+// Timings and sizes of one training step; times are in milliseconds
+struct StepMetrics
+{
+    size_t epoch = 0;
+    size_t step = 0;
+    size_t batch_size = 0;
+    double loss = 0.0;
+    double data_ms = 0.0;
+    double forward_ms = 0.0;
+    double loss_ms = 0.0;
+    double backward_ms = 0.0;
+    double optimizer_ms = 0.0;
+    double step_ms = 0.0;
+    double samples_per_sec = 0.0;
+    uint64_t graph_nodes = 0; // nodes built by the step
+    uint64_t graph_bytes = 0; // memory they held before backward
+};
+
+// Milliseconds since construction or the last lap(). A named lap is also recorded as a
+// trace span while agrad::trace is active.
+class PhaseTimer
+{
+private:
+    uint64_t last = agrad::trace::now_ns();
+
+public:
+    double lap(const char *span = nullptr)
+    {
+        uint64_t now = agrad::trace::now_ns();
+        if (span && agrad::trace::active())
+        {
+            agrad::trace::complete(span, "train", last, now);
+        }
+        double ms = (now - last) / 1e6;
+        last = now;
+        return ms;
+    }
+};
+
+// Appends one record per step to a JSON-lines or CSV file. Records are formatted into an
+// in-memory buffer that is written out once it exceeds buffer_size, so a step costs a
+// snprintf and no syscall.
+class TelemetryWriter
+{
+private:
+    std::ofstream out;
+    TelemetryFormat format;
+    std::string buffer;
+    size_t buffer_size;
+
+public:
+    TelemetryWriter(const std::string &filename, TelemetryFormat format = TelemetryFormat::JsonLines, size_t buffer_size = 1 << 16)
+        : out(filename, std::ios::trunc), format(format), buffer_size(buffer_size)
+    {
+        if (!out)
+        {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+        buffer.reserve(buffer_size + 512);
+        if (format == TelemetryFormat::Csv)
+        {
+            buffer += "epoch,step,batch_size,loss,data_ms,forward_ms,loss_ms,backward_ms,optimizer_ms,step_ms,samples_per_sec,graph_nodes,graph_bytes\n";
+        }
+    }
+
+    TelemetryWriter(const TelemetryWriter &) = delete;
+    TelemetryWriter &operator=(const TelemetryWriter &) = delete;
+
+    ~TelemetryWriter()
+    {
+        flush();
+    }
+
+    void write(const StepMetrics &m)
+    {
+        const char *pattern = format == TelemetryFormat::Csv
+                                  ? "%zu,%zu,%zu,%.9g,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%llu,%llu\n"
+                                  : "{\"epoch\":%zu,\"step\":%zu,\"batch_size\":%zu,\"loss\":%.9g,\"data_ms\":%.6f,\"forward_ms\":%.6f,\"loss_ms\":%.6f,"
+                                    "\"backward_ms\":%.6f,\"optimizer_ms\":%.6f,\"step_ms\":%.6f,\"samples_per_sec\":%.3f,\"graph_nodes\":%llu,\"graph_bytes\":%llu}\n";
+
+        char line[512];
+        int n = std::snprintf(line, sizeof(line), pattern, m.epoch, m.step, m.batch_size, m.loss,
+                              m.data_ms, m.forward_ms, m.loss_ms, m.backward_ms, m.optimizer_ms, m.step_ms, m.samples_per_sec,
+                              static_cast<unsigned long long>(m.graph_nodes), static_cast<unsigned long long>(m.graph_bytes));
+        buffer.append(line, n);
+
+        if (buffer.size() >= buffer_size)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!buffer.empty())
+        {
+            out.write(buffer.data(), buffer.size());
+            out.flush();
+            buffer.clear();
+        }
+    }
+};
@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include "agrad/Loss.hpp"
+#include "agrad/Memory.hpp"
+#include "data/BatchLoader.hpp"
+#include "data/DataLoader.hpp"
+#include "MLP.hpp"
+#include "Telemetry.hpp"
+
+struct TrainerConfig
+{
+    double learning_rate = 0.001;
+    size_t batch_size = 1; // for train_epoch(const Dataset &); a BatchLoader has its own
+    std::string telemetry_path; // empty disables per-step telemetry
+    TelemetryFormat telemetry_format = TelemetryFormat::JsonLines;
+    size_t log_every = 1; // write every n-th step
+};
+
+// Totals over one epoch; phase times are in milliseconds
+struct EpochStats
+{
+    size_t epoch = 0;
+    size_t steps = 0;
+    size_t samples = 0;
+    double loss = 0.0;     // mean batch loss
+    double accuracy = 0.0; // percent
+    double data_ms = 0.0;
+    double forward_ms = 0.0;
+    double loss_ms = 0.0;
+    double backward_ms = 0.0;
+    double optimizer_ms = 0.0;
+    double total_ms = 0.0;
+    double samples_per_sec = 0.0;
+    uint64_t peak_graph_nodes = 0;
+};
+
+struct EvalStats
+{
+    double loss = 0.0; // mean squared error
+    double accuracy = 0.0;
+};
+
+// Mini-batch SGD over an MLP that times every phase of a step (batching, forward, loss,
+// backward, optimizer) and measures the autograd graph each step builds
+class Trainer
+{
+public:
+    using LossFn = std::function<Value::ValuePtr(const std::vector<Value::ValuePtr> &, const std::vector<double> &)>;
+
+private:
+    MLP &model;
+    TrainerConfig config;
+    LossFn loss_fn;
+    std::vector<Value::ValuePtr> params;
+    std::unique_ptr<TelemetryWriter> telemetry;
+    size_t epoch = 0;
+    size_t global_step = 0;
+
+    // Labels are +-1 and predictions are thresholded at 0.5
+    static bool correct(double prediction, double label) { return (prediction > 0.5) == (label == 1); }
+
+public:
+    // The model's parameters are captured once, so setParameters() on it needs a new Trainer
+    Trainer(MLP &model, TrainerConfig config = {}, LossFn loss_fn = agrad::loss::mse)
+        : model(model), config(std::move(config)), loss_fn(std::move(loss_fn)), params(model.parameters())
+    {
+        if (this->config.batch_size == 0)
+        {
+            throw std::invalid_argument("Batch size must be positive");
+        }
+        if (this->config.log_every == 0)
+        {
+            throw std::invalid_argument("Log interval must be positive");
+        }
+        if (!this->config.telemetry_path.empty())
+        {
+            telemetry = std::make_unique<TelemetryWriter>(this->config.telemetry_path, this->config.telemetry_format);
+        }
+    }
+
+    // One epoch over the batches of loader; batch preparation runs on its workers while this
+    // thread trains, so data_ms is only the time spent waiting for the next batch
+    EpochStats train_epoch(BatchLoader &loader)
+    {
+        EpochStats stats;
+        stats.epoch = epoch++;
+        double correct_count = 0.0;
+
+        while (true)
+        {
+            StepMetrics m;
+            m.epoch = stats.epoch;
+            m.step = global_step;
+            PhaseTimer timer;
+            const uint64_t step_start = agrad::trace::now_ns();
+            auto mem_before = agrad::memory::stats();
+
+            const MiniBatch *batch = loader.next();
+            if (!batch)
+            {
+                break;
+            }
+            const size_t batch_size = batch->size();
+            m.batch_size = batch_size;
+            m.data_ms = timer.lap("data");
+
+            auto y_pred = model(batch->x);
+            m.forward_ms = timer.lap("forward");
+
+            Value::ValuePtr loss = loss_fn(y_pred, batch->y);
+            m.loss = loss->getData();
+            for (size_t z = 0; z < batch_size; z++)
+            {
+                correct_count += correct(y_pred[z]->getData(), batch->y[z]);
+            }
+            m.loss_ms = timer.lap("loss");
+
+            auto mem_graph = agrad::memory::stats();
+            m.graph_nodes = mem_graph.created - mem_before.created;
+            m.graph_bytes = mem_graph.bytes() > mem_before.bytes() ? mem_graph.bytes() - mem_before.bytes() : 0;
+
+            // Releasing the graph is part of the backward cost
+            loss->backward();
+            loss.reset();
+            y_pred.clear();
+            m.backward_ms = timer.lap("backward");
+
+            for (auto &p : params)
+            {
+                p->setData(p->getData() - config.learning_rate * p->getGrad());
+                p->setGrad(0.0);
+            }
+            m.optimizer_ms = timer.lap("optimizer");
+            if (agrad::trace::active())
+            {
+                agrad::trace::complete("step", "train", step_start, agrad::trace::now_ns(), global_step);
+            }
+
+            m.step_ms = m.data_ms + m.forward_ms + m.loss_ms + m.backward_ms + m.optimizer_ms;
+            m.samples_per_sec = m.step_ms > 0.0 ? batch_size * 1000.0 / m.step_ms : 0.0;
+
+            stats.steps++;
+            stats.samples += batch_size;
+            stats.loss += m.loss;
+            stats.data_ms += m.data_ms;
+            stats.forward_ms += m.forward_ms;
+            stats.loss_ms += m.loss_ms;
+            stats.backward_ms += m.backward_ms;
+            stats.optimizer_ms += m.optimizer_ms;
+            stats.peak_graph_nodes = std::max(stats.peak_graph_nodes, m.graph_nodes);
+
+            if (telemetry && global_step % config.log_every == 0)
+            {
+                telemetry->write(m);
+            }
+            global_step++;
+        }
+
+        stats.total_ms = stats.data_ms + stats.forward_ms + stats.loss_ms + stats.backward_ms + stats.optimizer_ms;
+        if (stats.steps > 0)
+        {
+            stats.loss /= stats.steps;
+            stats.accuracy = correct_count / stats.samples * 100.0;
+        }
+        stats.samples_per_sec = stats.total_ms > 0.0 ? stats.samples * 1000.0 / stats.total_ms : 0.0;
+        return stats;
+    }
+
+    // One epoch in dataset order on this thread, skipping a final partial batch
+    EpochStats train_epoch(const Dataset &train)
+    {
+        BatchLoaderOptions options;
+        options.batch_size = config.batch_size;
+        options.shuffle = false;
+        options.drop_last = true;
+        options.workers = 0;
+        BatchLoader loader(train, options);
+        return train_epoch(loader);
+    }
+
+    // Graph-free evaluation on a frozen snapshot of the model
+    EvalStats evaluate(const Dataset &data) const
+    {
+        agrad::trace::Scope span("evaluate", "train");
+        EvalStats stats;
+        if (data.empty())
+        {
+            return stats;
+        }
+
+        const size_t n = data.size();
+        const Dataset packed = data.is_contiguous() ? data : data.materialize();
+        auto frozen = model.freeze();
+        std::vector<double> pred(n * frozen.getOutputs());
+        frozen.predict(packed.data(), n, pred.data());
+
+        double correct_count = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            double p = pred[i * frozen.getOutputs()];
+            double diff = p - packed.label(i);
+            stats.loss += diff * diff;
+            correct_count += correct(p, packed.label(i));
+        }
+        stats.loss /= n;
+        stats.accuracy = correct_count / n * 100.0;
+        return stats;
+    }
+
+    void flush_telemetry()
+    {
+        if (telemetry)
+        {
+            telemetry->flush();
+        }
+    }
+
+    size_t getStep() const { return global_step; }
+    size_t getEpoch() const { return epoch; }
+};
@@ -1,36 +1,46 @@
 #pragma once
+#include <functional>
 #include <vector>
 #include "agrad/Value.hpp"
 #include <matplot/matplot.h>
+#include "nn/DecisionMap.hpp"
 #include "nn/MLP.hpp"
 #include "data/DataLoader.hpp"
 
-class Visualization
+// Grid coordinates and predicted classes of a decision map as the nested vectors matplot
+// takes; only the plotting side pays for this layout
+struct DecisionMesh
 {
-private:
-    std::vector<std::vector<double>> X; // Input features
-    std::vector<double> y;              // Labels
-    MLP &model;                         // Reference to the model
+    std::vector<std::vector<double>> x;
+    std::vector<std::vector<double>> y;
+    std::vector<std::vector<double>> z;
+};
 
-    // Helper function to create mesh grid
-    std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>>
-    meshgrid(const std::vector<double> &x, const std::vector<double> &y)
+inline DecisionMesh decision_mesh(const DecisionMap &map)
+{
+    const DecisionGrid &grid = map.getGrid();
+    DecisionMesh mesh;
+    mesh.x.assign(grid.ny, std::vector<double>(grid.nx));
+    mesh.y.assign(grid.ny, std::vector<double>(grid.nx));
+    mesh.z.assign(grid.ny, std::vector<double>(grid.nx));
+    for (size_t i = 0; i < grid.ny; i++)
     {
-        size_t nx = x.size();
-        size_t ny = y.size();
-        std::vector<std::vector<double>> X(ny, std::vector<double>(nx));
-        std::vector<std::vector<double>> Y(ny, std::vector<double>(nx));
-
-        for (size_t i = 0; i < ny; i++)
+        for (size_t j = 0; j < grid.nx; j++)
         {
-            for (size_t j = 0; j < nx; j++)
-            {
-                X[i][j] = x[j];
-                Y[i][j] = y[i];
-            }
+            mesh.x[i][j] = grid.x(j);
+            mesh.y[i][j] = grid.y(i);
+            mesh.z[i][j] = map.label(i, j);
         }
-        return {X, Y};
     }
+    return mesh;
+}
+
+class Visualization
+{
+private:
+    std::vector<std::vector<double>> X; // Input features
+    std::vector<double> y;              // Labels
+    MLP &model;                         // Reference to the model
 
     // Helper function to get min/max of a column
     std::pair<double, double> get_column_range(const std::vector<std::vector<double>> &data, int col)
@@ -46,17 +56,6 @@ private:
         return {min_val, max_val};
     }
 
-    // Create range with step size
-    std::vector<double> arange(double start, double end, double step)
-    {
-        std::vector<double> range;
-        for (double i = start; i < end; i += step)
-        {
-            range.push_back(i);
-        }
-        return range;
-    }
-
 public:
     Visualization(std::vector<std::vector<double>> &features,
                   std::vector<double> &labels,
@@ -74,47 +73,17 @@ public:
         y_min -= 1.0;
         y_max += 1.0;
 
-        // Create mesh grid
-        auto x_range = arange(x_min, x_max, h);
-        auto y_range = arange(y_min, y_max, h);
-        auto [xx, yy] = meshgrid(x_range, y_range);
-
-        // Create input points from mesh
-        std::vector<std::vector<double>> X_mesh;
-        for (size_t i = 0; i < xx.size(); i++)
-        {
-            for (size_t j = 0; j < xx[0].size(); j++)
-            {
-                X_mesh.push_back({xx[i][j], yy[i][j]});
-            }
-        }
-
-        // Evaluate model on mesh points
-        std::vector<bool> Z;
-        for (const auto &x_point : X_mesh)
-        {
-            Value score = *model(x_point)[0];
-            Z.push_back(score.getData() > 0);
-        }
-
-        // Reshape Z to match xx shape
-        std::vector<std::vector<bool>> Z_reshaped(xx.size(),
-                                                  std::vector<bool>(xx[0].size()));
-        size_t k = 0;
-        for (size_t i = 0; i < xx.size(); i++)
-        {
-            for (size_t j = 0; j < xx[0].size(); j++)
-            {
-                Z_reshaped[i][j] = Z[k++];
-            }
-        }
+        // Evaluate the frozen model over the grid on every core, without autograd graphs
+        const DecisionGrid grid = DecisionGrid::with_step(x_min, x_max, y_min, y_max, h);
+        const DecisionMap map = DecisionMap::evaluate(model.freeze(), grid);
+        auto [xx, yy, Z] = decision_mesh(map);
 
         // Plot using matplot++
         auto f = matplot::figure(true);
 
         // Plot decision boundary
         auto ax = f->add_axes();
-        ax->contourf(xx, yy, Z_reshaped);
+        ax->contourf(xx, yy, Z);
 
         // Plot data points
         std::vector<double> x_pos, y_pos, x_neg, y_neg;
@@ -147,6 +116,47 @@ public:
 
 class DatasetVisualizer
 {
+private:
+    // A point-wise classifier in the shape DecisionMap evaluates: its class is the one output
+    struct ClassifierModel
+    {
+        const std::function<int(double, double)> &classifier;
+
+        int getInputs() const { return 2; }
+        int getOutputs() const { return 1; }
+        void predict(const double *x, size_t n, double *out) const
+        {
+            for (size_t k = 0; k < n; k++)
+            {
+                out[k] = classifier(x[2 * k], x[2 * k + 1]);
+            }
+        }
+    };
+
+    static void plot_points(const Dataset &dataset)
+    {
+        std::vector<double> x1_pos, x2_pos;
+        std::vector<double> x1_neg, x2_neg;
+
+        for (size_t i = 0; i < dataset.size(); i++)
+        {
+            const double *x = dataset.row(i);
+            if (dataset.label(i) == 1.0)
+            {
+                x1_pos.push_back(x[0]);
+                x2_pos.push_back(x[1]);
+            }
+            else
+            {
+                x1_neg.push_back(x[0]);
+                x2_neg.push_back(x[1]);
+            }
+        }
+
+        matplot::scatter(x1_pos, x2_pos)->marker_color({1, 0, 0}).marker_face(true).display_name("Class +1");
+        matplot::scatter(x1_neg, x2_neg)->marker_color({0, 0, 1}).marker_face(true).display_name("Class -1");
+    }
+
 public:
     static void visualize_dataset(const Dataset &dataset, const std::string &title = "Dataset Visualization")
     {
@@ -154,17 +164,18 @@ public:
         std::vector<double> x1_neg, x2_neg; // Features for negative class
 
         // Separate data points by class
-        for (size_t i = 0; i < dataset.X.size(); i++)
+        for (size_t i = 0; i < dataset.size(); i++)
         {
-            if (dataset.y[i] == 1.0)
+            const double *x = dataset.row(i);
+            if (dataset.label(i) == 1.0)
             {
-                x1_pos.push_back(dataset.X[i][0]);
-                x2_pos.push_back(dataset.X[i][1]);
+                x1_pos.push_back(x[0]);
+                x2_pos.push_back(x[1]);
             }
             else
             {
-                x1_neg.push_back(dataset.X[i][0]);
-                x2_neg.push_back(dataset.X[i][1]);
+                x1_neg.push_back(x[0]);
+                x2_neg.push_back(x[1]);
             }
         }
 
@@ -196,50 +207,43 @@ public:
         matplot::show();
     }
 
+    // Samples classifier adaptively over the data range with a margin of 1: a coarse grid,
+    // refined only where neighbouring samples disagree (see DecisionMap::adaptive), so most
+    // of the plane costs one call per 16x16 block. Positive classes are drawn as one region.
     static void visualize_with_decision_boundary(
         const Dataset &dataset,
         const std::function<int(double, double)> &classifier,
+        const std::string &title = "Decision Boundary Visualization",
+        size_t resolution = 1000)
+    {
+        // The classifier may not be thread safe, so it is sampled on this thread
+        const ClassifierModel model{classifier};
+        const DecisionGrid grid = DecisionGrid::around(dataset, resolution, resolution);
+        visualize_with_decision_boundary(dataset, DecisionMap::adaptive(model, grid, 16, 1), title);
+    }
+
+    // Same plot from a precomputed DecisionMap
+    static void visualize_with_decision_boundary(
+        const Dataset &dataset,
+        const DecisionMap &map,
         const std::string &title = "Decision Boundary Visualization")
     {
-        // Create figure
         auto f = matplot::figure(true);
         f->size(1200, 800);
 
-        // Plot decision boundary contour
-        auto c = matplot::fcontour(classifier, "b")->filled(true).line_width(0.5);
+        auto [xx, yy, Z] = decision_mesh(map);
+        matplot::contourf(xx, yy, Z);
         matplot::colormap({{1.0, 0.8, 0.8}, {0.9, 1.0, 0.9}});
 
         matplot::hold(matplot::on);
+        plot_points(dataset);
 
-        // Plot dataset points
-        std::vector<double> x1_pos, x2_pos;
-        std::vector<double> x1_neg, x2_neg;
-
-        for (size_t i = 0; i < dataset.X.size(); i++)
-        {
-            if (dataset.y[i] == 1.0)
-            {
-                x1_pos.push_back(dataset.X[i][0]);
-                x2_pos.push_back(dataset.X[i][1]);
-            }
-            else
-            {
-                x1_neg.push_back(dataset.X[i][0]);
-                x2_neg.push_back(dataset.X[i][1]);
-            }
-        }
-
-        matplot::scatter(x1_pos, x2_pos)->marker_color({1, 0, 0}).marker_face(true).display_name("Class +1");
-        matplot::scatter(x1_neg, x2_neg)->marker_color({0, 0, 1}).marker_face(true).display_name("Class -1");
-
-        // Customize the plot
         matplot::title(title);
         matplot::xlabel("Feature X1");
         matplot::ylabel("Feature X2");
         matplot::colorbar(matplot::off);
         matplot::grid(matplot::on);
 
-        // Show the plot
         matplot::show();
     }
 };
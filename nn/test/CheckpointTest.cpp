@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "nn/MLP.hpp"
+
+class CheckpointTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mlp = new MLP(3, {6, 4, 2}, false);
+        std::vector<Value::ValuePtr> params;
+        for (int i = 0; i < mlp->parameters().size(); i++)
+        {
+            params.push_back(Value::create(std::sin(0.37 * i)));
+        }
+        mlp->setParameters(params);
+        path = (std::filesystem::temp_directory_path() / "agrad_checkpoint_test.bin").string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+        delete mlp;
+    }
+
+    MLP *mlp;
+    std::string path;
+    std::vector<double> input = {0.5, -1.0, 2.0};
+};
+
+TEST_F(CheckpointTest, RoundTrip)
+{
+    mlp->save(path);
+    MLP loaded = MLP::load(path);
+
+    auto params = mlp->parameters();
+    auto loaded_params = loaded.parameters();
+    ASSERT_EQ(loaded_params.size(), params.size());
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        EXPECT_DOUBLE_EQ(loaded_params[i]->getData(), params[i]->getData());
+    }
+    EXPECT_DOUBLE_EQ(loaded(input)[1]->getData(), (*mlp)(input)[1]->getData());
+}
+
+TEST_F(CheckpointTest, LoadLeavesInitStreamsAlone)
+{
+    mlp->save(path);
+    Init::seed(7);
+    MLP fresh(3, {4, 1});
+    Init::seed(7);
+    MLP loaded = MLP::load(path);
+    MLP after_load(3, {4, 1});
+
+    // Loading draws no weights, so the next model still gets the streams fresh got
+    auto expected = fresh.parameters();
+    auto actual = after_load.parameters();
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(actual[i]->getData(), expected[i]->getData());
+    }
+}
+
+TEST_F(CheckpointTest, MappedLoad)
+{
+    mlp->save(path);
+    auto frozen = Checkpoint::load<double>(path);
+    EXPECT_EQ(frozen.getInputs(), 3);
+    EXPECT_EQ(frozen.getOutputs(), 2);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(frozen.getWeights(0)) % Checkpoint::blob_alignment, 0);
+
+    auto expected = mlp->freeze()(input);
+    auto output = frozen(input);
+    EXPECT_DOUBLE_EQ(output[0], expected[0]);
+    EXPECT_DOUBLE_EQ(output[1], expected[1]);
+}
+
+TEST_F(CheckpointTest, FloatCheckpoint)
+{
+    mlp->save<float>(path);
+    EXPECT_LT(std::filesystem::file_size(path), mlp->parameters().size() * sizeof(double));
+
+    auto as_float = Checkpoint::load<float>(path);
+    auto as_double = Checkpoint::load<double>(path);
+    EXPECT_NEAR(as_double(input)[0], (*mlp)(input)[0]->getData(), 1e-5);
+    EXPECT_NEAR(as_float(input)[0], as_double(input)[0], 1e-5);
+}
+
+TEST_F(CheckpointTest, InvalidFile)
+{
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a checkpoint at all, just some text to fill the header";
+    }
+    EXPECT_THROW(MLP::load(path), std::runtime_error);
+
+    // Truncated blob
+    mlp->save(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(Checkpoint::load<double>(path), std::runtime_error);
+
+    EXPECT_THROW(MLP::load(path + ".missing"), std::runtime_error);
+}
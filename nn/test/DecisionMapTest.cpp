@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "nn/DecisionMap.hpp"
+#include "nn/MLP.hpp"
+#include "nn/QuantizedMLP.hpp"
+
+class DecisionMapTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mlp = new MLP(2, {8, 3}, false);
+        std::vector<Value::ValuePtr> params;
+        for (int i = 0; i < mlp->parameters().size(); i++)
+        {
+            params.push_back(Value::create(std::sin(0.53 * i)));
+        }
+        mlp->setParameters(params);
+    }
+
+    void TearDown() override
+    {
+        delete mlp;
+    }
+
+    MLP *mlp;
+};
+
+TEST_F(DecisionMapTest, Grids)
+{
+    // Laid out like numpy.arange: the upper end is excluded
+    DecisionGrid step = DecisionGrid::with_step(-1.0, 1.0, 0.0, 0.5, 0.25);
+    EXPECT_EQ(step.nx, 8);
+    EXPECT_EQ(step.ny, 2);
+    EXPECT_DOUBLE_EQ(step.x(7), 0.75);
+
+    DecisionGrid size = DecisionGrid::with_size(-1.0, 1.0, 2.0, 4.0, 5, 3);
+    EXPECT_DOUBLE_EQ(size.x(0), -1.0);
+    EXPECT_DOUBLE_EQ(size.x(4), 1.0);
+    EXPECT_DOUBLE_EQ(size.y(2), 4.0);
+    EXPECT_EQ(size.size(), 15);
+
+    Dataset points(2, 2);
+    points.row(0)[0] = 0.0;
+    points.row(0)[1] = 5.0;
+    points.row(1)[0] = 2.0;
+    points.row(1)[1] = -1.0;
+    DecisionGrid around = DecisionGrid::around(points, 3, 3, 0.5);
+    EXPECT_DOUBLE_EQ(around.x(0), -0.5);
+    EXPECT_DOUBLE_EQ(around.x(2), 2.5);
+    EXPECT_DOUBLE_EQ(around.y(0), -1.5);
+    EXPECT_DOUBLE_EQ(around.y(2), 5.5);
+
+    EXPECT_THROW(DecisionGrid::with_step(0.0, 1.0, 0.0, 1.0, 0.0), std::invalid_argument);
+    EXPECT_THROW(DecisionGrid::with_size(0.0, 1.0, 0.0, 1.0, 1, 4), std::invalid_argument);
+    EXPECT_THROW(DecisionGrid::around(Dataset(0, 2), 4, 4), std::invalid_argument);
+}
+
+TEST_F(DecisionMapTest, MatchesPointwise)
+{
+    auto frozen = mlp->freeze();
+    // Not a multiple of the tile size, so threads and tiles end mid-row
+    const DecisionGrid grid = DecisionGrid::with_size(-2.0, 2.0, -1.0, 1.0, 97, 53);
+
+    for (size_t threads : {1, 3})
+    {
+        const DecisionMap map = DecisionMap::evaluate(frozen, grid, threads);
+        ASSERT_EQ(map.getOutputs(), 3);
+        for (size_t i = 0; i < grid.ny; i += 7)
+        {
+            for (size_t j = 0; j < grid.nx; j += 5)
+            {
+                const std::vector<double> expected = frozen({grid.x(j), grid.y(i)});
+                for (size_t o = 0; o < 3; o++)
+                {
+                    EXPECT_DOUBLE_EQ(map.score(i, j, o), expected[o]);
+                }
+                const int best = std::max_element(expected.begin(), expected.end()) - expected.begin();
+                EXPECT_EQ(map.label(i, j), best);
+            }
+        }
+        // The last point is filled too
+        EXPECT_DOUBLE_EQ(map.score(grid.ny - 1, grid.nx - 1), frozen({grid.x(grid.nx - 1), grid.y(grid.ny - 1)})[0]);
+    }
+}
+
+TEST_F(DecisionMapTest, BinaryLabelsAndNormalizer)
+{
+    MLP binary(2, {4, 1}, false);
+    auto frozen = binary.freeze();
+    const DecisionGrid grid = DecisionGrid::with_size(0.0, 10.0, 100.0, 200.0, 40, 30);
+
+    // Scaling the grid into the training units is the same as evaluating scaled points
+    Dataset raw(2, 2);
+    raw.row(0)[0] = 0.0;
+    raw.row(0)[1] = 100.0;
+    raw.row(1)[0] = 10.0;
+    raw.row(1)[1] = 200.0;
+    const Normalizer normalizer(FeatureStats::of(raw), NormalizeMode::MinMax);
+    const DecisionMap map = DecisionMap::evaluate(frozen, grid, 2, &normalizer);
+    for (size_t i = 0; i < grid.ny; i += 4)
+    {
+        for (size_t j = 0; j < grid.nx; j += 3)
+        {
+            const double score = frozen(normalizer.transform({grid.x(j), grid.y(i)}))[0];
+            EXPECT_DOUBLE_EQ(map.score(i, j), score);
+            EXPECT_EQ(map.label(i, j), score > 0.0 ? 1 : -1);
+        }
+    }
+
+    // Quantized models share the batched interface
+    Dataset calibration(16, 2);
+    for (size_t i = 0; i < 16; i++)
+    {
+        calibration.row(i)[0] = std::cos(0.4 * i);
+        calibration.row(i)[1] = std::sin(0.4 * i);
+    }
+    const auto quantized = QuantizedMLP::quantize(frozen, calibration);
+    const DecisionGrid small = DecisionGrid::with_size(-1.0, 1.0, -1.0, 1.0, 8, 8);
+    const DecisionMap qmap = DecisionMap::evaluate(quantized, small, 1);
+    EXPECT_DOUBLE_EQ(qmap.score(3, 5), quantized({small.x(5), small.y(3)})[0]);
+
+    MLP wide(3, {4, 1}, false);
+    EXPECT_THROW(DecisionMap::evaluate(wide.freeze(), grid), std::invalid_argument);
+}
+
+TEST_F(DecisionMapTest, AdaptiveMatchesDense)
+{
+    // Sizes that are not multiples of the cell leave uneven cells along the last row and column
+    const DecisionGrid grid = DecisionGrid::with_size(-3.0, 3.0, -3.0, 3.0, 301, 203);
+    auto frozen = mlp->freeze();
+    const DecisionMap dense = DecisionMap::evaluate(frozen, grid, 1);
+    const DecisionMap adaptive = DecisionMap::adaptive(frozen, grid, 8, 3);
+
+    size_t differ = 0;
+    for (size_t i = 0; i < grid.ny; i++)
+    {
+        for (size_t j = 0; j < grid.nx; j++)
+        {
+            differ += adaptive.label(i, j) != dense.label(i, j);
+        }
+    }
+    EXPECT_LT(differ, grid.size() / 1000);
+    EXPECT_LT(adaptive.getEvaluations(), grid.size() / 3);
+    EXPECT_EQ(dense.getEvaluations(), grid.size());
+
+    // An affine model is interpolated exactly, and its straight boundary never hides inside
+    // a cell whose corners agree
+    MLP linear(2, {1}, false);
+    auto line = linear.freeze();
+    const DecisionMap exact = DecisionMap::evaluate(line, grid);
+    const DecisionMap refined = DecisionMap::adaptive(line, grid, 16);
+    for (size_t i = 0; i < grid.ny; i++)
+    {
+        for (size_t j = 0; j < grid.nx; j++)
+        {
+            ASSERT_NEAR(refined.score(i, j), exact.score(i, j), 1e-9);
+            ASSERT_EQ(refined.label(i, j), exact.label(i, j));
+        }
+    }
+    EXPECT_LT(refined.getEvaluations(), grid.size() / 10);
+
+    // Degenerate grids and cells larger than the grid
+    const DecisionGrid row = DecisionGrid::with_step(0.0, 5.0, 0.0, 0.5, 0.5);
+    ASSERT_EQ(row.ny, 1);
+    const DecisionMap row_map = DecisionMap::adaptive(line, row, 64);
+    for (size_t j = 0; j < row.nx; j++)
+    {
+        EXPECT_EQ(row_map.label(0, j), DecisionMap::evaluate(line, row).label(0, j));
+    }
+    EXPECT_THROW(DecisionMap::adaptive(line, grid, 0), std::invalid_argument);
+}
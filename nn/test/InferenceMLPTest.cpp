@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "nn/MLP.hpp"
+
+class InferenceMLPTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mlp = new MLP(3, {8, 5, 2}, false); // tanh hidden layers, wide enough to hit the SIMD path
+        // Set deterministic, distinct parameters for testing
+        std::vector<Value::ValuePtr> params;
+        for (int i = 0; i < mlp->parameters().size(); i++)
+        {
+            params.push_back(Value::create(std::sin(0.37 * i)));
+        }
+        mlp->setParameters(params);
+    }
+
+    void TearDown() override
+    {
+        delete mlp;
+    }
+
+    MLP *mlp;
+};
+
+TEST_F(InferenceMLPTest, MatchesGraph)
+{
+    auto frozen = mlp->freeze();
+    std::vector<double> input = {0.5, -1.0, 2.0};
+    auto expected = (*mlp)(input);
+    auto output = frozen(input);
+
+    ASSERT_EQ(output.size(), 2);
+    EXPECT_NEAR(output[0], expected[0]->getData(), 1e-12);
+    EXPECT_NEAR(output[1], expected[1]->getData(), 1e-12);
+}
+
+TEST_F(InferenceMLPTest, BatchedPredict)
+{
+    auto frozen = mlp->freeze();
+    const size_t n = 150; // spans several tiles
+    std::vector<double> x(n * 3);
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        x[i] = std::cos(0.11 * i);
+    }
+    std::vector<double> out(n * 2);
+    frozen.predict(x.data(), n, out.data());
+
+    for (size_t r = 0; r < n; r += 37)
+    {
+        auto expected = (*mlp)(std::vector<double>(x.begin() + r * 3, x.begin() + r * 3 + 3));
+        EXPECT_NEAR(out[r * 2], expected[0]->getData(), 1e-12);
+        EXPECT_NEAR(out[r * 2 + 1], expected[1]->getData(), 1e-12);
+    }
+}
+
+TEST_F(InferenceMLPTest, FloatPrecision)
+{
+    auto frozen = mlp->freeze<float>();
+    std::vector<double> input = {0.5, -1.0, 2.0};
+    auto expected = (*mlp)(input);
+    auto output = frozen(input);
+    EXPECT_NEAR(output[0], expected[0]->getData(), 1e-5);
+    EXPECT_NEAR(output[1], expected[1]->getData(), 1e-5);
+}
+
+TEST_F(InferenceMLPTest, ReLU)
+{
+    MLP relu_mlp(2, {3, 1});
+    std::vector<Value::ValuePtr> params;
+    for (int i = 0; i < relu_mlp.parameters().size(); i++)
+    {
+        params.push_back(Value::create(i % 2 ? -0.3 : 0.2));
+    }
+    relu_mlp.setParameters(params);
+
+    std::vector<double> input = {1.0, -2.0};
+    EXPECT_NEAR(relu_mlp.freeze()(input)[0], relu_mlp(input)[0]->getData(), 1e-12);
+}
+
+TEST_F(InferenceMLPTest, InvalidConstruction)
+{
+    using Spec = InferenceMLP<>::LayerSpec;
+    EXPECT_THROW(InferenceMLP<>({}, {}, {}), std::invalid_argument);
+    EXPECT_THROW(InferenceMLP<>({Spec{2, 3, true, true}, Spec{2, 1, false, true}}, std::vector<double>(8), std::vector<double>(4)), std::invalid_argument);
+    EXPECT_THROW(InferenceMLP<>({Spec{2, 1, false, true}}, std::vector<double>(3), std::vector<double>(1)), std::invalid_argument);
+    EXPECT_THROW(mlp->freeze()(std::vector<double>{1.0}), std::invalid_argument);
+}
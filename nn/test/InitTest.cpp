@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "nn/MLP.hpp"
+
+static std::vector<double> parameter_values(const Module &module)
+{
+    std::vector<double> values;
+    for (auto &p : module.parameters())
+    {
+        values.push_back(p->getData());
+    }
+    return values;
+}
+
+TEST(InitTest, PhiloxKnownAnswers)
+{
+    // Reference vectors from the Random123 distribution
+    EXPECT_EQ(Philox::generate({0, 0, 0, 0}, {0, 0}), (Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(InitTest, Reproducible)
+{
+    Init::seed(42);
+    MLP a(4, {8, 1});
+    Init::seed(42);
+    MLP b(4, {8, 1});
+    Init::seed(43);
+    MLP c(4, {8, 1});
+
+    EXPECT_EQ(parameter_values(a), parameter_values(b));
+    EXPECT_NE(parameter_values(a), parameter_values(c));
+}
+
+TEST(InitTest, ParallelMatchesSerial)
+{
+    // Big enough to be initialized on several threads; neuron i must still get stream i
+    Init::seed(7);
+    Layer layer(512, 256, true);
+    auto values = parameter_values(layer);
+
+    Init::seed(7);
+    uint64_t first = Init::reserve_streams(256);
+    Neuron last(512, true, true, InitScheme::Uniform, 256, first + 255);
+    auto expected = parameter_values(last);
+
+    ASSERT_EQ(values.size(), 256 * 513);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), values.end() - 513));
+}
+
+TEST(InitTest, Schemes)
+{
+    const int fan_in = 400, fan_out = 200;
+    std::vector<double> w(20000);
+
+    Init::fill(w.data(), w.size(), InitScheme::XavierUniform, fan_in, fan_out, 0);
+    double bound = std::sqrt(6.0 / (fan_in + fan_out));
+    for (double v : w)
+    {
+        ASSERT_LE(std::abs(v), bound);
+    }
+
+    Init::fill(w.data(), w.size(), InitScheme::KaimingNormal, fan_in, fan_out, 1);
+    double mean = 0.0, var = 0.0;
+    for (double v : w)
+    {
+        mean += v;
+    }
+    mean /= w.size();
+    for (double v : w)
+    {
+        var += (v - mean) * (v - mean);
+    }
+    var /= w.size();
+    EXPECT_NEAR(mean, 0.0, 0.01);
+    EXPECT_NEAR(var, 2.0 / fan_in, 0.1 * 2.0 / fan_in);
+
+    EXPECT_THROW(Init::fill(w.data(), w.size(), InitScheme::Uniform, 0, 1, 0), std::invalid_argument);
+}
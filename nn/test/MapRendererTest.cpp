@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "nn/MapRenderer.hpp"
+#include "nn/MLP.hpp"
+
+namespace
+{
+    std::vector<uint8_t> read_file(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t be32(const uint8_t *p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    // Just enough inflate for the fixed-Huffman blocks the PNG writer emits
+    class Inflater
+    {
+    private:
+        const std::vector<uint8_t> &in;
+        size_t bit = 0;
+
+        uint32_t bits(int n)
+        {
+            uint32_t v = 0;
+            for (int i = 0; i < n; i++, bit++)
+            {
+                v |= ((in.at(bit / 8) >> (bit % 8)) & 1u) << i;
+            }
+            return v;
+        }
+
+        uint32_t code(int n)
+        {
+            uint32_t v = 0;
+            for (int i = 0; i < n; i++)
+            {
+                v = (v << 1) | bits(1);
+            }
+            return v;
+        }
+
+        uint32_t symbol()
+        {
+            uint32_t c = code(7);
+            if (c <= 23)
+            {
+                return 256 + c;
+            }
+            c = (c << 1) | bits(1);
+            if (c >= 0x30 && c <= 0xBF)
+            {
+                return c - 0x30;
+            }
+            if (c >= 0xC0 && c <= 0xC7)
+            {
+                return 280 + c - 0xC0;
+            }
+            return 144 + ((c << 1) | bits(1)) - 0x190;
+        }
+
+    public:
+        explicit Inflater(const std::vector<uint8_t> &in) : in(in) {}
+
+        std::vector<uint8_t> run()
+        {
+            static const uint16_t base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                              35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static const uint8_t extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            bit = 16; // zlib header
+            EXPECT_EQ(bits(1), 1u);
+            EXPECT_EQ(bits(2), 1u);
+            std::vector<uint8_t> out;
+            while (true)
+            {
+                const uint32_t s = symbol();
+                if (s < 256)
+                {
+                    out.push_back(static_cast<uint8_t>(s));
+                    continue;
+                }
+                if (s == 256)
+                {
+                    return out;
+                }
+                const size_t length = base[s - 257] + bits(extra[s - 257]);
+                EXPECT_EQ(code(5), 0u); // distance 1
+                for (size_t k = 0; k < length; k++)
+                {
+                    out.push_back(out.back());
+                }
+            }
+        }
+    };
+}
+
+class MapRendererTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        base = (std::filesystem::temp_directory_path() / "agrad_map_test").string();
+        // Positive for x > 0: a vertical boundary through the middle of the grid
+        model = new MLP(2, {1}, false);
+        model->setParameters({Value::create(0.0), Value::create(1.0), Value::create(0.0)});
+    }
+
+    void TearDown() override
+    {
+        delete model;
+        for (const char *ext : {".ppm", ".png", ".async.png"})
+        {
+            std::filesystem::remove(base + ext);
+        }
+    }
+
+    std::string base;
+    MLP *model;
+};
+
+TEST_F(MapRendererTest, RendersClassesWithYUp)
+{
+    const DecisionGrid grid = DecisionGrid::with_size(-1.0, 1.0, 0.0, 1.0, 40, 21);
+    const DecisionMap map = DecisionMap::evaluate(model->freeze(), grid);
+
+    // One labelled point at the top left of the plane
+    Dataset points(1, 2);
+    points.row(0)[0] = -1.0;
+    points.row(0)[1] = 1.0;
+    points.label(0) = 1.0;
+
+    RenderOptions options;
+    options.shade = false;
+    options.point_radius = 2;
+    const Image image = MapRenderer::render(map, &points, options);
+    ASSERT_EQ(image.getWidth(), 40);
+    ASSERT_EQ(image.getHeight(), 21);
+
+    // Light blue on the negative side, light red on the positive side
+    const uint8_t *left = image.pixel(5, 10);
+    const uint8_t *right = image.pixel(35, 10);
+    EXPECT_GT(left[2], left[0]);
+    EXPECT_GT(right[0], right[2]);
+    EXPECT_EQ(std::memcmp(image.pixel(5, 3), left, 3), 0);
+
+    // The last column before the class changes is dark
+    const uint8_t *edge = image.pixel(19, 10);
+    EXPECT_LT(edge[0], 100);
+
+    // The point lands at the top left, in full red
+    const uint8_t *dot = image.pixel(0, 0);
+    EXPECT_EQ(dot[0], 220);
+    EXPECT_EQ(dot[1], 40);
+    EXPECT_EQ(std::memcmp(image.pixel(0, 20), image.pixel(5, 10), 3), 0);
+}
+
+TEST_F(MapRendererTest, WritesPpmAndPng)
+{
+    const DecisionGrid grid = DecisionGrid::with_size(-1.0, 1.0, -1.0, 1.0, 300, 200);
+    const Image image = MapRenderer::render(DecisionMap::evaluate(model->freeze(), grid));
+    image.save(base + ".ppm");
+    image.save(base + ".png");
+    EXPECT_THROW(image.save(base + ".jpg"), std::invalid_argument);
+
+    const std::vector<uint8_t> ppm = read_file(base + ".ppm");
+    const std::string header = "P6\n300 200\n255\n";
+    ASSERT_EQ(ppm.size(), header.size() + 300 * 200 * 3);
+    EXPECT_EQ(std::string(ppm.begin(), ppm.begin() + header.size()), header);
+    const uint8_t *pixels = ppm.data() + header.size();
+
+    const std::vector<uint8_t> png = read_file(base + ".png");
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    ASSERT_GT(png.size(), 8u);
+    EXPECT_EQ(std::memcmp(png.data(), signature, 8), 0);
+    // Flat regions compress to a small fraction of the raw pixels
+    EXPECT_LT(png.size(), ppm.size() / 10);
+
+    // Walk the chunks, then inflate and unfilter IDAT back to the PPM pixels
+    std::vector<uint8_t> idat;
+    std::vector<std::string> types;
+    for (size_t p = 8; p < png.size();)
+    {
+        const uint32_t length = be32(&png[p]);
+        types.emplace_back(png.begin() + p + 4, png.begin() + p + 8);
+        if (types.back() == "IHDR")
+        {
+            EXPECT_EQ(be32(&png[p + 8]), 300u);
+            EXPECT_EQ(be32(&png[p + 12]), 200u);
+        }
+        if (types.back() == "IDAT")
+        {
+            idat.assign(png.begin() + p + 8, png.begin() + p + 8 + length);
+        }
+        p += 12 + length;
+    }
+    EXPECT_EQ(types, (std::vector<std::string>{"IHDR", "IDAT", "IEND"}));
+
+    const std::vector<uint8_t> rows = Inflater(idat).run();
+    const size_t stride = 300 * 3;
+    ASSERT_EQ(rows.size(), 200 * (stride + 1));
+    std::vector<uint8_t> decoded(200 * stride);
+    for (size_t y = 0; y < 200; y++)
+    {
+        const uint8_t filter = rows[y * (stride + 1)];
+        ASSERT_LE(filter, 2);
+        for (size_t i = 0; i < stride; i++)
+        {
+            const uint8_t prior = filter == 1 ? (i >= 3 ? decoded[y * stride + i - 3] : 0) : filter == 2 ? (y > 0 ? decoded[(y - 1) * stride + i] : 0)
+                                                                                                         : 0;
+            decoded[y * stride + i] = static_cast<uint8_t>(rows[y * (stride + 1) + 1 + i] + prior);
+        }
+    }
+    EXPECT_EQ(std::memcmp(decoded.data(), pixels, decoded.size()), 0);
+}
+
+TEST_F(MapRendererTest, WritesInBackground)
+{
+    Dataset points(2, 2);
+    points.row(0)[0] = -0.5;
+    points.row(0)[1] = 0.0;
+    points.label(0) = -1.0;
+    points.row(1)[0] = 0.5;
+    points.row(1)[1] = 0.0;
+    points.label(1) = 1.0;
+
+    auto frozen = model->freeze();
+    auto written = MapRenderer::write_async(frozen, DecisionGrid::around(points, 120, 80), points, base + ".async.png");
+    // Training may change the live model while the snapshot renders
+    model->setParameters({Value::create(5.0), Value::create(-1.0), Value::create(0.0)});
+    written.get();
+    EXPECT_GT(std::filesystem::file_size(base + ".async.png"), 0u);
+
+    auto failed = MapRenderer::write_async(frozen, DecisionGrid::around(points, 120, 80), points, base + ".gif");
+    EXPECT_THROW(failed.get(), std::invalid_argument);
+}
@@ -46,11 +46,21 @@ TEST_F(NeuronTest, Backward)
     std::vector<double> input = {2.0, 2.0, 2.0};
     Value::ValuePtr output = (*neuron)(input);
     output->backward();
-    EXPECT_DOUBLE_EQ(neuron->parameters()[0]->getGrad(), 0.0); // bias
+    EXPECT_DOUBLE_EQ(neuron->parameters()[0]->getGrad(), 1.0); // bias
     EXPECT_DOUBLE_EQ(neuron->parameters()[1]->getGrad(), 2.0); // w0
     EXPECT_DOUBLE_EQ(neuron->parameters()[2]->getGrad(), 2.0); // w1
 }
 
+TEST_F(NeuronTest, SingleNode)
+{
+    std::vector<Value::ValuePtr> input = {Value::create(1.0), Value::create(2.0), Value::create(3.0)};
+    Value::ValuePtr output = (*neuron)(input);
+    EXPECT_EQ(output->getOp(), "linear");
+    EXPECT_EQ(output->getChildren().size(), 7); // bias, 3 weights, 3 inputs
+    output->backward();
+    EXPECT_DOUBLE_EQ(input[2]->getGrad(), 0.5);
+}
+
 TEST_F(NeuronTest, InvalidInput)
 {
     std::vector<double> invalid_input = {1.0}; // Only one input
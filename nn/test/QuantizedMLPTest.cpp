@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "nn/QuantizedMLP.hpp"
+
+class QuantizedMLPTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mlp = new MLP(2, {40, 16, 1}, false); // first hidden layer is wider than one SIMD row
+        std::vector<Value::ValuePtr> params;
+        for (int i = 0; i < mlp->parameters().size(); i++)
+        {
+            params.push_back(Value::create(0.5 * std::sin(1.3 * i)));
+        }
+        mlp->setParameters(params);
+
+        for (int i = 0; i < 200; i++)
+        {
+            double x1 = std::cos(0.7 * i) * 1.5;
+            double x2 = std::sin(0.3 * i);
+            dataset.push_back({x1, x2}, x1 * x2 > 0 ? 1.0 : -1.0);
+        }
+    }
+
+    void TearDown() override
+    {
+        delete mlp;
+    }
+
+    MLP *mlp;
+    Dataset dataset;
+};
+
+TEST_F(QuantizedMLPTest, CloseToFloat)
+{
+    auto frozen = mlp->freeze();
+    auto quantized = QuantizedMLP::quantize(frozen, dataset, 64);
+    EXPECT_EQ(quantized.getInputs(), 2);
+    EXPECT_EQ(quantized.getOutputs(), 1);
+
+    for (size_t i = 0; i < dataset.size(); i += 17)
+    {
+        EXPECT_NEAR(quantized(dataset.row_vector(i))[0], frozen(dataset.row_vector(i))[0], 0.1);
+    }
+}
+
+TEST_F(QuantizedMLPTest, Report)
+{
+    auto frozen = mlp->freeze();
+    auto [train, test] = DataLoader::train_test_split(dataset, 0.5);
+    auto quantized = QuantizedMLP::quantize(*mlp, train);
+    auto report = QuantizedMLP::compare(frozen, quantized, test);
+
+    EXPECT_EQ(report.samples, test.size());
+    EXPECT_GT(report.agreement, 0.9);
+    EXPECT_LE(report.mean_abs_error, report.max_abs_error);
+    EXPECT_LT(report.max_abs_error, 0.1);
+}
+
+TEST_F(QuantizedMLPTest, CalibrationScale)
+{
+    // The first layer sees raw inputs, whose largest magnitude is 1.5
+    auto quantized = QuantizedMLP::quantize(*mlp, dataset, dataset.size());
+    EXPECT_NEAR(quantized.getInputScale(0), 1.5 / 127.0, 1e-6);
+}
+
+TEST_F(QuantizedMLPTest, EmptyCalibration)
+{
+    EXPECT_THROW(QuantizedMLP::quantize(*mlp, Dataset{}), std::invalid_argument);
+}
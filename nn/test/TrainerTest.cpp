@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "nn/Trainer.hpp"
+
+class TrainerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Init::seed(7);
+        // Two separable clusters with +-1 labels
+        for (int i = 0; i < 32; i++)
+        {
+            double label = i % 2 ? 1.0 : -1.0;
+            data.push_back({label + 0.1 * std::sin(i), label + 0.1 * std::cos(i)}, label);
+        }
+        path = (std::filesystem::temp_directory_path() / "agrad_trainer_test.log").string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    static std::vector<std::string> read_lines(const std::string &file)
+    {
+        std::ifstream in(file);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);)
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    Dataset data;
+    std::string path;
+};
+
+TEST_F(TrainerTest, LossDecreases)
+{
+    MLP model(2, {8, 1}, false);
+    TrainerConfig config;
+    config.learning_rate = 0.05;
+    config.batch_size = 4;
+    Trainer trainer(model, config);
+
+    auto first = trainer.train_epoch(data);
+    EpochStats last;
+    for (int i = 0; i < 20; i++)
+    {
+        last = trainer.train_epoch(data);
+    }
+
+    EXPECT_EQ(first.steps, 8);
+    EXPECT_EQ(first.samples, 32);
+    EXPECT_LT(last.loss, first.loss);
+    EXPECT_EQ(trainer.getStep(), 21 * 8);
+    EXPECT_GT(last.samples_per_sec, 0.0);
+    EXPECT_GT(last.peak_graph_nodes, 0);
+    EXPECT_NEAR(last.total_ms, last.data_ms + last.forward_ms + last.loss_ms + last.backward_ms + last.optimizer_ms, 1e-9);
+
+    auto eval = trainer.evaluate(data);
+    EXPECT_GE(eval.accuracy, 0.0);
+    EXPECT_LE(eval.accuracy, 100.0);
+}
+
+TEST_F(TrainerTest, TrainsFromBatchLoader)
+{
+    MLP model(2, {8, 1}, false);
+    TrainerConfig config;
+    config.learning_rate = 0.05;
+    Trainer trainer(model, config);
+
+    BatchLoaderOptions options;
+    options.batch_size = 5;
+    options.workers = 2;
+    BatchLoader loader(data, options);
+
+    auto first = trainer.train_epoch(loader);
+    EpochStats last;
+    for (int i = 0; i < 20; i++)
+    {
+        last = trainer.train_epoch(loader);
+    }
+
+    // 32 rows in batches of 5, the last one partial
+    EXPECT_EQ(first.steps, 7);
+    EXPECT_EQ(first.samples, 32);
+    EXPECT_EQ(loader.getEpoch(), 21);
+    EXPECT_LT(last.loss, first.loss);
+}
+
+TEST_F(TrainerTest, JsonLinesTelemetry)
+{
+    MLP model(2, {4, 1}, false);
+    TrainerConfig config;
+    config.batch_size = 8;
+    config.telemetry_path = path;
+    {
+        Trainer trainer(model, config);
+        trainer.train_epoch(data);
+    }
+
+    auto lines = read_lines(path);
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_EQ(lines[0].front(), '{');
+    EXPECT_EQ(lines[0].back(), '}');
+    EXPECT_NE(lines[0].find("\"step\":0,"), std::string::npos);
+    EXPECT_NE(lines[3].find("\"step\":3,"), std::string::npos);
+    EXPECT_NE(lines[0].find("\"graph_nodes\":"), std::string::npos);
+    EXPECT_EQ(lines[0].find("\"graph_nodes\":0,"), std::string::npos);
+}
+
+TEST_F(TrainerTest, CsvTelemetry)
+{
+    MLP model(2, {4, 1}, false);
+    TrainerConfig config;
+    config.batch_size = 4;
+    config.telemetry_path = path;
+    config.telemetry_format = TelemetryFormat::Csv;
+    config.log_every = 2;
+    {
+        Trainer trainer(model, config);
+        trainer.train_epoch(data);
+    }
+
+    auto lines = read_lines(path);
+    ASSERT_EQ(lines.size(), 1 + 4);
+    EXPECT_EQ(lines[0].rfind("epoch,step,batch_size,loss", 0), 0);
+    EXPECT_EQ(lines[2].rfind("0,2,4,", 0), 0);
+}
+
+TEST_F(TrainerTest, InvalidBatchSize)
+{
+    MLP model(2, {1}, false);
+    TrainerConfig config;
+    config.batch_size = 0;
+    EXPECT_THROW(Trainer(model, config), std::invalid_argument);
+}
+
+TEST_F(TrainerTest, InvalidLogInterval)
+{
+    MLP model(2, {1}, false);
+    TrainerConfig config;
+    config.log_every = 0;
+    EXPECT_THROW(Trainer(model, config), std::invalid_argument);
+}